@@ -28,9 +28,11 @@
 #include <cstdio>
 #include <ctime>
 #include <climits>
+#include <limits>
 #include <string>
 #include <fstream>
 #include <iomanip>
+#include <sstream>
 #include <stdexcept>
 
 //#include <mcheck.h>
@@ -44,6 +46,7 @@
 #include "../frontier_lib/BigInteger.hpp"
 #include "../frontier_lib/HyperGraph.hpp"
 #include "../frontier_lib/FrontierAlgorithm.hpp"
+#include "../frontier_lib/ZDDApply.hpp"
 //#include "../frontier_lib/Automaton.hpp"
 
 #include "StateCombination.hpp"
@@ -80,6 +83,11 @@ public:
         return static_cast<double>(num);
     }
 
+    static double GetDouble(double num)
+    {
+        return num;
+    }
+
     static double GetDouble(BigInteger num)
     {
         return static_cast<double>(num);
@@ -91,24 +99,26 @@ public:
         T num;
         num = zdd->ComputeNumberOfSolutions<T>();
         if (is_compute_solution) {
-            std::cerr << "# of solutions = " << num;
-            double dnum = GetDouble(num);
-            if (dnum >= 1.0e+06) {
-                std::cerr << " (" << dnum << ")";
-            }
-            std::cerr << std::endl;
+            PrintNumber(num);
+        }
+    }
+
+    template <typename T>
+    static void PrintNumber(T num)
+    {
+        std::cerr << "# of solutions = " << num;
+        double dnum = GetDouble(num);
+        if (dnum >= 1.0e+06) {
+            std::cerr << " (" << dnum << ")";
         }
+        std::cerr << std::endl;
     }
 };
 
 template <>
-inline void NumPrinter::PrintNumberOfSolutions<double>(PseudoZDD* zdd, bool is_compute_solution, bool)
+inline void NumPrinter::PrintNumber<double>(double num)
 {
-    double num;
-    num = zdd->ComputeNumberOfSolutions<double>();
-    if (is_compute_solution) {
-        std::cerr << std::setprecision(15) << "# of solutions = " << num << std::endl;
-    }
+    std::cerr << std::setprecision(15) << "# of solutions = " << num << std::endl;
 }
 
 
@@ -136,6 +146,7 @@ public:
     bool is_cycle;    // if this option is true and enum_kind == STPATH or DSTPATH,
                              // enumerate cycles
     bool is_any_path; // enumerate paths from start_vertex to any vertex
+    bool is_lookahead; // prune states by looking ahead the unprocessed subgraph
     std::string terminal_filename;
     bool is_set_weight;
     std::string weight_filename;
@@ -154,7 +165,9 @@ public:
     bool is_ignore_isolated;
     bool is_print_parameter;
     bool is_reduce; // reduce the ZDD
+    bool is_reduce_on_the_fly; // reduce finished levels during the construction
     bool is_switch; // switch arcs
+    std::string hdd_filename; // output the (pseudo) ZDD to a HDD if not empty
     bool is_print_pzdd; // print the (pseudo) ZDD
     bool is_print_zdd_graphviz; // print the (pseudo) ZDD for graphviz
     bool is_print_zero; // print zero-terminal if true
@@ -164,16 +177,40 @@ public:
     bool is_compute_solution; // compute and print the number of solutions of the
                                    // constructed ZDD
     bool is_enum; // enumerate and output all solutions
+    int dist_kind; // output the distribution of solutions by the size or the weight
+    std::string dist_filename;
+    bool is_marginal; // output the number of solutions including each edge
+    std::vector<int> restrict_list; // edges fixed by --restrict (negative: excluded)
+    std::string subsetting_filename; // construct only the subsets of the family in this ZDD
+    PseudoZDD* subsetting_dd;
+    int apply_op; // combine the ZDD with the ZDD in apply_filename (-1: none)
+    std::string apply_filename;
+    std::string marginal_filename;
     std::string enum_filename;
     bool is_sample; // sample solutions randomly
     std::string sample_filename;
     int sample_num; // the number of solutions to sample
+    uint64 seed; // the seed of random sampling
+    int opt_kind; // output the best solutions (OPT_NONE, OPT_MIN or OPT_MAX)
+    std::string opt_filename;
+    intx opt_num; // the number of the best solutions to output
+    bool is_pareto; // output the Pareto optimal solutions for two weights
+    std::string pareto_weight1_filename;
+    std::string pareto_weight2_filename;
+    std::string pareto_filename;
+    bool is_boltzmann; // sample solutions with probability proportional to exp(-beta * weight)
+    double beta;
     bool is_random_graphviz;
     bool is_hex; // hexadecimal ZDD node ID
     //bool is_use_automaton; // construct the automaton from the ZDD
     //bool is_print_am; // print the constructed automaton
     int precision_kind;
     bool is_print_progress;
+    int eval_kind; // evaluate a semiring value without constructing the ZDD
+    bool is_set_probability;
+    std::string probability_filename;
+    bool is_reliability; // compute the probabilities for many scenarios on the ZDD
+    std::string reliability_filename;
     RootManager root_mgr;
 
     enum {
@@ -208,7 +245,29 @@ public:
         INTX,
         DOUBLE,
         BIGINT,
-        GMP
+        GMP,
+        MODULAR, // counting modulo several primes and reconstruct by CRT
+        ADAPTIVE // counting with the number of limbs chosen for each level
+    };
+
+    enum { // opt_kind
+        OPT_NONE,
+        OPT_MIN, // in ascending order of the total weight
+        OPT_MAX // in descending order of the total weight
+    };
+
+    enum { // dist_kind
+        DIST_NONE,
+        DIST_SIZE, // by the number of edges
+        DIST_WEIGHT // by the total weight of edges
+    };
+
+    enum { // eval_kind
+        EVAL_NONE,
+        EVAL_COUNT, // the number of solutions
+        EVAL_MIN, // the minimum weight of solutions
+        EVAL_MAX, // the maximum weight of solutions
+        EVAL_PROB // the probability that the set of used edges is a solution
     };
 
     OptionParser()
@@ -233,6 +292,12 @@ public:
         is_hamilton = false; 
         is_cycle = false;    
         is_any_path = false; 
+        is_lookahead = false;
+        eval_kind = EVAL_NONE;
+        is_set_probability = false;
+        probability_filename = "";
+        is_reliability = false;
+        reliability_filename = "";
         terminal_filename = "";
         is_set_weight = false;
         weight_filename = "";
@@ -251,6 +316,7 @@ public:
         is_ignore_isolated = false;
         is_print_parameter = false;
         is_reduce = false; 
+        is_reduce_on_the_fly = false;
         is_switch = false; 
         is_print_pzdd = true; 
         is_print_zdd_graphviz = false; 
@@ -260,10 +326,28 @@ public:
         print_zdd_sbdd_filename = "";
         is_compute_solution = true;         
         is_enum = false; 
+        dist_kind = DIST_NONE;
+        dist_filename = "";
+        is_marginal = false;
+        subsetting_filename = "";
+        subsetting_dd = NULL;
+        apply_op = -1;
+        apply_filename = "";
+        marginal_filename = "";
         enum_filename = "";
         is_sample = false; 
         sample_filename = "";
         sample_num = 100; 
+        seed = static_cast<uint64>(time(NULL));
+        opt_kind = OPT_NONE;
+        opt_filename = "";
+        opt_num = 1;
+        is_pareto = false;
+        pareto_weight1_filename = "";
+        pareto_weight2_filename = "";
+        pareto_filename = "";
+        is_boltzmann = false;
+        beta = 1.0;
         is_random_graphviz = false;
         is_hex = false; 
         //is_use_automaton = false;
@@ -277,6 +361,9 @@ public:
         if (state != NULL) {
             delete state;
         }
+        if (subsetting_dd != NULL) {
+            delete subsetting_dd;
+        }
         if (hgraph != NULL) {
             delete hgraph;
         }
@@ -414,6 +501,8 @@ public:
                 is_cycle = true;
             } else if (arg == "--any") {
                 is_any_path = true;
+            } else if (arg == "--lookahead") {
+                is_lookahead = true;
             } else if (arg == "--terminal") {
                 if (i + 1 < argc) {
                     terminal_filename = argv[i + 1];
@@ -481,8 +570,45 @@ public:
                 }
             } else if (arg == "-r") {
                 is_reduce = true;
+            } else if (arg == "--reduce-on-the-fly") {
+                is_reduce_on_the_fly = true;
             } else if (arg == "--switch") {
                 is_switch = true;
+            } else if (arg == "--eval") {
+                std::string kind = (i + 1 < argc ? argv[i + 1] : "");
+                ++i;
+                if (kind == "count") {
+                    eval_kind = EVAL_COUNT;
+                } else if (kind == "min") {
+                    eval_kind = EVAL_MIN;
+                } else if (kind == "max") {
+                    eval_kind = EVAL_MAX;
+                } else if (kind == "prob") {
+                    eval_kind = EVAL_PROB;
+                } else {
+                    std::cerr << "Error: unknown kind for --eval: " << kind << "." << std::endl;
+                    exit(1);
+                }
+            } else if (arg == "--prob") {
+                is_set_probability = true;
+                if (i + 1 < argc) {
+                    probability_filename = argv[i + 1];
+                    ++i;
+                }
+            } else if (arg == "--reliability") {
+                is_reliability = true;
+                if (i + 1 < argc) {
+                    reliability_filename = argv[i + 1];
+                    ++i;
+                }
+            } else if (arg == "--hdd") {
+                if (i + 1 < argc) {
+                    hdd_filename = argv[i + 1];
+                    ++i;
+                } else {
+                    std::cerr << "Error: need a filename after --hdd." << std::endl;
+                    exit(1);
+                }
             } else if (arg == "-n" || arg == "--no-print-zdd") {
                 is_print_pzdd = false;
             } else if (arg == "--print-zdd-graphviz") {
@@ -516,6 +642,10 @@ public:
                 precision_kind = DOUBLE;
             } else if (arg == "--sb") {
                 precision_kind = BIGINT;
+            } else if (arg == "--smod") {
+                precision_kind = MODULAR;
+            } else if (arg == "--sv") {
+                precision_kind = ADAPTIVE;
             } else if (arg == "--sa") {
                 std::cerr << "The option of --sa (using apfloat) is obsolete." << std::endl;
                 exit(1);
@@ -532,6 +662,92 @@ public:
                     enum_filename = argv[i + 1];
                     ++i;
                 }
+            } else if (arg == "--opt") {
+                std::string kind = (i + 1 < argc ? argv[i + 1] : "");
+                if (kind == "min") {
+                    opt_kind = OPT_MIN;
+                } else if (kind == "max") {
+                    opt_kind = OPT_MAX;
+                } else {
+                    std::cerr << "Error: unknown kind for --opt: " << kind << "." << std::endl;
+                    exit(1);
+                }
+                if (i + 3 >= argc) {
+                    std::cerr << "Error: --opt needs a kind, a filename and the number of "
+                              << "solutions." << std::endl;
+                    exit(1);
+                }
+                opt_filename = argv[i + 2];
+                char* end;
+                opt_num = strtoll(argv[i + 3], &end, 10);
+                if (*end != '\0' || opt_num <= 0) {
+                    std::cerr << "Error: invalid number of solutions for --opt: " << argv[i + 3]
+                              << "." << std::endl;
+                    exit(1);
+                }
+                i += 3;
+            } else if (arg == "--pareto") {
+                is_pareto = true;
+                if (i + 3 < argc) {
+                    pareto_weight1_filename = argv[i + 1];
+                    pareto_weight2_filename = argv[i + 2];
+                    pareto_filename = argv[i + 3];
+                    i += 3;
+                } else {
+                    std::cerr << "Error: --pareto needs two weight files and an output file."
+                              << std::endl;
+                    exit(1);
+                }
+            } else if (arg == "--dist") {
+                std::string kind = (i + 1 < argc ? argv[i + 1] : "");
+                if (kind == "size") {
+                    dist_kind = DIST_SIZE;
+                } else if (kind == "weight") {
+                    dist_kind = DIST_WEIGHT;
+                } else {
+                    std::cerr << "Error: unknown kind for --dist: " << kind << "." << std::endl;
+                    exit(1);
+                }
+                if (i + 2 < argc) {
+                    dist_filename = argv[i + 2];
+                }
+                i += 2;
+            } else if (arg == "--subset") {
+                if (i + 1 < argc) {
+                    subsetting_filename = argv[i + 1];
+                    ++i;
+                }
+            } else if (arg == "--apply") {
+                std::string op = (i + 1 < argc ? argv[i + 1] : "");
+                if (op == "union") {
+                    apply_op = ZDDApply::UNION;
+                } else if (op == "intersection") {
+                    apply_op = ZDDApply::INTERSECTION;
+                } else if (op == "difference") {
+                    apply_op = ZDDApply::DIFFERENCE;
+                } else if (op == "join") {
+                    apply_op = ZDDApply::JOIN;
+                } else if (op == "disjoint-product") {
+                    apply_op = ZDDApply::DISJOINT_PRODUCT;
+                } else {
+                    std::cerr << "Error: unknown operation for --apply: " << op << "." << std::endl;
+                    exit(1);
+                }
+                if (i + 2 < argc) {
+                    apply_filename = argv[i + 2];
+                }
+                i += 2;
+            } else if (arg == "--restrict") {
+                if (i + 1 < argc) {
+                    ParseRestrictList(argv[i + 1]);
+                    ++i;
+                }
+            } else if (arg == "--marginal") {
+                is_marginal = true;
+                if (i + 1 < argc) {
+                    marginal_filename = argv[i + 1];
+                    ++i;
+                }
             } else if (arg == "--sample") {
                 is_sample = true;
                 if (i + 1 < argc) {
@@ -543,6 +759,17 @@ public:
                     sample_num = atoi(argv[i + 1]);
                     ++i;
                 }
+            } else if (arg == "--seed") {
+                if (i + 1 < argc) {
+                    seed = strtoull(argv[i + 1], NULL, 10);
+                    ++i;
+                }
+            } else if (arg == "--beta") {
+                is_boltzmann = true;
+                if (i + 1 < argc) {
+                    beta = atof(argv[i + 1]);
+                    ++i;
+                }
             } else if (arg == "--random-graphviz") {
                 is_random_graphviz = true;
             } else if (arg == "--hex") {
@@ -573,6 +800,178 @@ public:
                 exit(1);
             }
         }
+        if (!restrict_list.empty() && is_switch) {
+            std::cerr << "Error: --restrict cannot be used with --switch." << std::endl;
+            exit(1);
+        }
+        if (apply_op >= 0 && is_switch) {
+            std::cerr << "Error: --apply cannot be used with --switch." << std::endl;
+            exit(1);
+        }
+        if (is_reduce_on_the_fly && is_switch) {
+            std::cerr << "Error: --reduce-on-the-fly cannot be used with --switch." << std::endl;
+            exit(1);
+        }
+        if (is_lookahead && !((enum_kind == STPATH && !is_use_elimit)
+                              || enum_kind == PATHMATCHING || enum_kind == MTPATH)) {
+            std::cerr << "Error: --lookahead can be used only with -t stpath (without --elimit), "
+                      << "-t pathmatching and -t mtpath." << std::endl;
+            exit(1);
+        }
+        if (!hdd_filename.empty() && (is_reduce_on_the_fly || is_switch || is_print_zdd_graphviz
+                                      || is_print_zdd_sbdd || is_enum || is_sample
+                                      || is_random_graphviz || dist_kind != DIST_NONE
+                                      || opt_kind != OPT_NONE || is_pareto
+                                      || is_reliability || is_marginal
+                                      || !restrict_list.empty() || apply_op >= 0)) {
+            std::cerr << "Error: --hdd can be used only with -r, -n and the options "
+                      << "for counting solutions." << std::endl;
+            exit(1);
+        }
+        if (!hdd_filename.empty() && precision_kind == MODULAR) {
+            std::cerr << "Error: --smod cannot be used with --hdd." << std::endl;
+            exit(1);
+        }
+        if (!hdd_filename.empty() && precision_kind == ADAPTIVE) {
+            std::cerr << "Error: --sv cannot be used with --hdd." << std::endl;
+            exit(1);
+        }
+        if (eval_kind != EVAL_NONE && (!hdd_filename.empty() || is_reduce || is_reduce_on_the_fly
+                                       || precision_kind == MODULAR || precision_kind == ADAPTIVE
+                                       || is_print_zdd_graphviz || is_print_zdd_sbdd || is_enum
+                                       || is_sample || is_random_graphviz
+                                       || dist_kind != DIST_NONE || opt_kind != OPT_NONE
+                                       || is_pareto
+                                       || is_reliability
+                                       || is_marginal || !restrict_list.empty()
+                                       || apply_op >= 0)) {
+            std::cerr << "Error: --eval cannot be used with the options that need the ZDD."
+                      << std::endl;
+            exit(1);
+        }
+        if (eval_kind == EVAL_PROB && !is_set_probability) {
+            std::cerr << "Error: --eval prob needs --prob." << std::endl;
+            exit(1);
+        }
+    }
+
+    // ファイル probability_filename から各辺が使われる確率を読み込む。
+    // 書かれた数字が辺の個数より少ない場合はエラーとする。
+    void ReadProbabilities(std::vector<double>* probability_array) const
+    {
+        std::ifstream ifs(probability_filename.c_str());
+        if (!ifs) {
+            std::cerr << "cannot open " << probability_filename << std::endl;
+            exit(1);
+        }
+        probability_array->clear();
+        double p;
+        while (static_cast<int>(probability_array->size()) < igraph->GetNumberOfEdges()
+               && (ifs >> p)) {
+            probability_array->push_back(p);
+        }
+        if (static_cast<int>(probability_array->size()) < igraph->GetNumberOfEdges()) {
+            std::cerr << "Error: " << probability_filename << " has "
+                      << probability_array->size() << " numbers, but the graph has "
+                      << igraph->GetNumberOfEdges() << " edges." << std::endl;
+            exit(1);
+        }
+    }
+
+    // 構築した ZDD (zdd) とファイル apply_filename の ZDD に apply_op の演算を行った ZDD を返す。
+    // ファイルの ZDD は -z で出力される形式で、同じグラフの辺の順序で作られたものとする。
+    PseudoZDD* ApplyOperation(const PseudoZDD& zdd) const
+    {
+        std::ifstream ifs(apply_filename.c_str());
+        if (!ifs) {
+            std::cerr << "cannot open " << apply_filename << std::endl;
+            exit(1);
+        }
+        PseudoZDD other_zdd;
+        other_zdd.ImportZDD(ifs, is_hex);
+
+        ZDDApply apply;
+        intx f = apply.Import(zdd);
+        intx g = apply.Import(other_zdd);
+        return apply.Export(apply.Apply(apply_op, f, g));
+    }
+
+    // "1,2,-5" のようなカンマ区切りの辺の番号の列を restrict_list に加える。
+    // 正の番号の辺は解に含まれ、負の番号の辺は解に含まれないものとする。
+    void ParseRestrictList(const std::string& str)
+    {
+        std::istringstream iss(str);
+        std::string token;
+        while (std::getline(iss, token, ',')) {
+            int e = atoi(token.c_str());
+            if (e == 0) {
+                std::cerr << "Error: invalid edge number for --restrict: " << token << "."
+                          << std::endl;
+                exit(1);
+            }
+            restrict_list.push_back(e);
+        }
+    }
+
+    // restrict_list から、各辺を含む (1)、含まない (0)、制限しない (-1) を表す配列を作る
+    void MakeRestrictArray(std::vector<int>* value_array) const
+    {
+        value_array->assign(igraph->GetNumberOfEdges(), -1);
+        for (uint i = 0; i < restrict_list.size(); ++i) {
+            int e = (restrict_list[i] > 0 ? restrict_list[i] : -restrict_list[i]);
+            if (e > igraph->GetNumberOfEdges()) {
+                std::cerr << "Error: edge " << e << " in --restrict does not exist." << std::endl;
+                exit(1);
+            }
+            (*value_array)[e - 1] = (restrict_list[i] > 0 ? 1 : 0);
+        }
+    }
+
+    // ファイル reliability_filename から各シナリオで各辺が使われる確率を読み込む。
+    // i 行目に辺 i の各シナリオでの確率を空白区切りで記入する（1 列が 1 シナリオ）。
+    // 行が辺の個数より少ない場合はエラーとする。シナリオ数を返す。
+    int ReadProbabilityMatrix(std::vector<std::vector<double> >* probability_matrix) const
+    {
+        std::ifstream ifs(reliability_filename.c_str());
+        if (!ifs) {
+            std::cerr << "cannot open " << reliability_filename << std::endl;
+            exit(1);
+        }
+        probability_matrix->clear();
+        int number_of_scenarios = -1;
+        std::string line;
+        while (static_cast<int>(probability_matrix->size()) < igraph->GetNumberOfEdges()
+               && std::getline(ifs, line)) {
+            std::istringstream iss(line);
+            std::vector<double> row;
+            double p;
+            while (iss >> p) {
+                row.push_back(p);
+            }
+            if (row.empty()) { // skip blank lines
+                continue;
+            }
+            if (number_of_scenarios < 0) {
+                number_of_scenarios = static_cast<int>(row.size());
+            } else if (static_cast<int>(row.size()) != number_of_scenarios) {
+                std::cerr << "Error: the number of scenarios differs in line "
+                          << probability_matrix->size() + 1 << " of "
+                          << reliability_filename << "." << std::endl;
+                exit(1);
+            }
+            probability_matrix->push_back(row);
+        }
+        if (number_of_scenarios < 0) {
+            std::cerr << "Error: no scenario in " << reliability_filename << "." << std::endl;
+            exit(1);
+        }
+        if (static_cast<int>(probability_matrix->size()) < igraph->GetNumberOfEdges()) {
+            std::cerr << "Error: " << reliability_filename << " has "
+                      << probability_matrix->size() << " rows, but the graph has "
+                      << igraph->GetNumberOfEdges() << " edges." << std::endl;
+            exit(1);
+        }
+        return number_of_scenarios;
     }
 
     void ParseCommandLine(const std::string& line)
@@ -823,15 +1222,20 @@ public:
                 static_cast<StateSTPath*>(state)->SetStartAndEndVertex(start_vertex, end_vertex);
                 static_cast<StateSTPath*>(state)->SetHamilton(is_hamilton);
                 static_cast<StateSTPath*>(state)->SetCycle(is_cycle);
+                if (enum_kind == STPATH) {
+                    static_cast<StateSTPath*>(state)->SetLookahead(is_lookahead);
+                }
             }
             break;
         case PATHMATCHING:
             state = new StatePathMatching(graph);
             static_cast<StatePathMatching*>(state)->SetHamilton(is_hamilton);
+            static_cast<StatePathMatching*>(state)->SetLookahead(is_lookahead);
             break;
         case MTPATH:
             state = new StateMTPath(graph);
             static_cast<StateMTPath*>(state)->SetHamilton(is_hamilton);
+            static_cast<StateMTPath*>(state)->SetLookahead(is_lookahead);
             static_cast<StateMTPath*>(state)->ParseTerminal(terminal_filename);
             break;
         case STEDPATH:
@@ -896,6 +1300,284 @@ public:
             break;
         }
         state->SetPrintProgress(is_print_progress);
+
+        if (subsetting_filename != "") {
+            std::ifstream ifs(subsetting_filename.c_str());
+            if (!ifs) {
+                std::cerr << "cannot open " << subsetting_filename << std::endl;
+                exit(1);
+            }
+            subsetting_dd = new PseudoZDD;
+            subsetting_dd->ImportZDD(ifs, is_hex); // ImportZDD はレベルの表も作る
+            state->SetSubsettingDD(subsetting_dd);
+        }
+    }
+
+    // ZDD を構築せずに、eval_kind で指定した値を計算して出力する
+    void Evaluate()
+    {
+        std::vector<double> weight_array;
+        if (eval_kind == EVAL_MIN || eval_kind == EVAL_MAX) {
+            for (int i = 0; i < igraph->GetNumberOfEdges(); ++i) {
+                weight_array.push_back(graph != NULL ? graph->GetEdge(i).weight
+                                       : hgraph->GetHyperEdge(i).weight);
+            }
+        } else if (eval_kind == EVAL_PROB) {
+            ReadProbabilities(&weight_array);
+        }
+
+        switch (eval_kind) {
+        case EVAL_COUNT:
+            EvaluateCount();
+            break;
+        case EVAL_MIN:
+            PrintOptimalWeight("minimum",
+                               FrontierAlgorithm::Evaluate(state, MinPlusSemiring(weight_array)));
+            break;
+        case EVAL_MAX:
+            PrintOptimalWeight("maximum",
+                               FrontierAlgorithm::Evaluate(state, MaxPlusSemiring(weight_array)));
+            break;
+        case EVAL_PROB:
+            state->FlushPrint();
+            std::cerr << std::setprecision(15) << "probability = "
+                      << FrontierAlgorithm::Evaluate(state, ProbabilitySemiring(weight_array))
+                      << std::endl;
+            break;
+        }
+    }
+
+    void EvaluateCount()
+    {
+        switch (precision_kind) {
+        case INTX:
+            EvaluateCount<uintx>();
+            break;
+        case DOUBLE:
+            EvaluateCount<double>();
+            break;
+        case BIGINT:
+            EvaluateCount<BigInteger>();
+            break;
+        case GMP:
+            EvaluateCount<MpInt>();
+            break;
+        default:
+#ifdef HAVE_LIBGMPXX
+            EvaluateCount<MpInt>();
+#else
+            EvaluateCount<BigInteger>();
+#endif
+            break;
+        }
+    }
+
+    template <typename T>
+    void EvaluateCount()
+    {
+        T num = FrontierAlgorithm::Evaluate(state, CountingSemiring<T>());
+        state->FlushPrint();
+        NumPrinter::PrintNumber(num);
+    }
+
+    void PrintOptimalWeight(const std::string& name, double weight)
+    {
+        state->FlushPrint();
+        if (weight == std::numeric_limits<double>::infinity()
+            || weight == -std::numeric_limits<double>::infinity()) {
+            std::cerr << "no solution" << std::endl;
+        } else {
+            std::cerr << std::setprecision(15) << name << " weight = " << weight << std::endl;
+        }
+    }
+
+    // 重みの和が最小（最大）の解から順に opt_num 個をファイル opt_filename に出力する
+    void OutputOptimalSolutions(PseudoZDD* zdd)
+    {
+        std::vector<intx> weight_array(igraph->GetNumberOfEdges());
+        for (int i = 0; i < igraph->GetNumberOfEdges(); ++i) {
+            weight_array[i] = (graph != NULL ? graph->GetEdge(i).weight
+                               : hgraph->GetHyperEdge(i).weight);
+        }
+        if (opt_filename == "") {
+            std::cerr << "Please input a filename for opt." << std::endl;
+            exit(1);
+        }
+        FILE* fout = stdout;
+        if (opt_filename != "-") {
+            fout = fopen(opt_filename.c_str(), "w");
+            if (fout == NULL) {
+                std::cerr << "file open error!" << std::endl;
+                exit(1);
+            }
+        }
+        intx num = zdd->OutputOptimalSolutions(fout, opt_num, weight_array,
+                                               opt_kind == OPT_MAX);
+        if (fout != stdout) {
+            fclose(fout);
+        }
+        if (num < opt_num) {
+            std::cerr << "Only " << num << " solutions exist." << std::endl;
+        }
+    }
+
+    // ファイル filename から --weight と同じ形式で辺の重みを読み込む。
+    // 重みが与えられていない辺の重みは 1 とする。
+    void ReadWeightArray(const std::string& filename, std::vector<intx>* weight_array)
+    {
+        std::ifstream ifs(filename.c_str());
+        if (!ifs) {
+            std::cerr << "cannot open " << filename << std::endl;
+            exit(1);
+        }
+        weight_array->assign(igraph->GetNumberOfEdges(), 1);
+        int c;
+        for (int i = 0; i < igraph->GetNumberOfEdges() && ifs >> c; ++i) {
+            (*weight_array)[i] = c;
+        }
+    }
+
+    // 2 つの重みの和が Pareto 最適な解をファイル pareto_filename に出力する
+    void OutputParetoSolutions(PseudoZDD* zdd)
+    {
+        std::vector<intx> weight1_array;
+        std::vector<intx> weight2_array;
+        ReadWeightArray(pareto_weight1_filename, &weight1_array);
+        ReadWeightArray(pareto_weight2_filename, &weight2_array);
+
+        FILE* fout = stdout;
+        if (pareto_filename != "-") {
+            fout = fopen(pareto_filename.c_str(), "w");
+            if (fout == NULL) {
+                std::cerr << "file open error!" << std::endl;
+                exit(1);
+            }
+        }
+        intx num = zdd->OutputParetoSolutions(fout, weight1_array, weight2_array);
+        if (fout != stdout) {
+            fclose(fout);
+        }
+        std::cerr << "# of Pareto optimal solutions = " << num << std::endl;
+    }
+
+    // 解を sample_num 個ランダムに取り出して fp に出力する。--beta が指定された場合は、
+    // 解 X を exp(-beta * (X の辺の重みの和)) に比例する確率で取り出し、分配関数の対数を
+    // 標準エラー出力に出力する。そうでなければ一様ランダムに取り出す。
+    void OutputSamples(PseudoZDD* zdd, FILE* fp)
+    {
+        if (!is_boltzmann) {
+            zdd->OutputSamplingSolutions(fp, sample_num, seed); // random sampling
+            return;
+        }
+        std::vector<double> log_weight_array(igraph->GetNumberOfEdges());
+        for (int i = 0; i < igraph->GetNumberOfEdges(); ++i) {
+            int weight = (graph != NULL ? graph->GetEdge(i).weight
+                          : hgraph->GetHyperEdge(i).weight);
+            log_weight_array[i] = -beta * weight;
+        }
+        std::cerr << "log Z = " << std::setprecision(15)
+                  << zdd->ComputeLogPartitionFunction(log_weight_array) << std::endl;
+        zdd->OutputWeightedSamplingSolutions(fp, sample_num, seed, log_weight_array);
+    }
+
+    // 解を辺の本数または重みの総和で分類した個数をファイル dist_filename に出力し、
+    // その平均と分散を標準エラー出力に出力する
+    template <typename T>
+    void OutputDistribution(PseudoZDD* zdd)
+    {
+        std::vector<int> weight_array(igraph->GetNumberOfEdges(), 1);
+        if (dist_kind == DIST_WEIGHT) {
+            for (int i = 0; i < igraph->GetNumberOfEdges(); ++i) {
+                weight_array[i] = (graph != NULL ? graph->GetEdge(i).weight
+                                   : hgraph->GetHyperEdge(i).weight);
+                if (weight_array[i] < 0) {
+                    std::cerr << "Error: --dist weight needs non-negative weights." << std::endl;
+                    exit(1);
+                }
+            }
+        }
+        std::vector<T> coef_array;
+        zdd->ComputeGeneratingFunction(weight_array, &coef_array);
+
+        if (dist_filename == "") {
+            std::cerr << "Please input a filename for dist." << std::endl;
+            exit(1);
+        }
+        std::ofstream ofs;
+        if (dist_filename != "-") {
+            ofs.open(dist_filename.c_str());
+            if (!ofs) {
+                std::cerr << "file open error!" << std::endl;
+                exit(1);
+            }
+        }
+        std::ostream& ost = (dist_filename == "-" ? std::cout : ofs);
+
+        double total = 0.0, sum = 0.0, square_sum = 0.0;
+        for (uint k = 0; k < coef_array.size(); ++k) {
+            double d = NumPrinter::GetDouble(coef_array[k]);
+            if (d != 0.0) {
+                ost << k << " " << coef_array[k] << std::endl;
+                total += d;
+                sum += d * k;
+                square_sum += d * k * k;
+            }
+        }
+        if (total > 0.0) {
+            double mean = sum / total;
+            std::cerr << std::setprecision(15) << "mean = " << mean << ", variance = "
+                      << square_sum / total - mean * mean << std::endl;
+        }
+    }
+
+    // 各辺について、その辺を含む解の個数と全解に対する割合をファイル marginal_filename に
+    // 出力し、全ての解で使われる辺と、どの解でも使われない辺を標準エラー出力に出力する
+    template <typename T>
+    void OutputMarginals(PseudoZDD* zdd)
+    {
+        std::vector<T> marginal_array;
+        T total = zdd->ComputeMarginals(&marginal_array);
+
+        if (marginal_filename == "") {
+            std::cerr << "Please input a filename for marginal." << std::endl;
+            exit(1);
+        }
+        std::ofstream ofs;
+        if (marginal_filename != "-") {
+            ofs.open(marginal_filename.c_str());
+            if (!ofs) {
+                std::cerr << "file open error!" << std::endl;
+                exit(1);
+            }
+        }
+        std::ostream& ost = (marginal_filename == "-" ? std::cout : ofs);
+
+        std::vector<int> always_array;
+        std::vector<int> never_array;
+        double d_total = NumPrinter::GetDouble(total);
+        // 全ての行を同じ精度で出力する（--sd のときは marginal も 15 桁になる）
+        std::streamsize old_precision = ost.precision(15);
+        for (int i = 0; i < igraph->GetNumberOfEdges(); ++i) {
+            T marginal = (i < static_cast<int>(marginal_array.size()) ? marginal_array[i] : T());
+            double d = NumPrinter::GetDouble(marginal);
+            ost << (i + 1) << " " << marginal << " "
+                << (d_total > 0.0 ? d / d_total : 0.0) << std::endl;
+            if (d == 0.0) {
+                never_array.push_back(i + 1);
+            } else if (marginal == total) {
+                always_array.push_back(i + 1);
+            }
+        }
+        ost.precision(old_precision);
+        std::cerr << "always used edges:";
+        for (uint i = 0; i < always_array.size(); ++i) {
+            std::cerr << " " << always_array[i];
+        }
+        std::cerr << std::endl << "never used edges:";
+        for (uint i = 0; i < never_array.size(); ++i) {
+            std::cerr << " " << never_array[i];
+        }
+        std::cerr << std::endl;
     }
 
     void Output(PseudoZDD* zdd)
@@ -912,6 +1594,22 @@ public:
             zdd->ReduceAsZDD(); // ZDDの既約化
         }
 
+        intx number_of_reduced_nodes = zdd->GetNumberOfNodes();
+
+        PseudoZDD* applied_zdd = NULL;
+        if (apply_op >= 0) {
+            applied_zdd = ApplyOperation(*zdd);
+            zdd = applied_zdd; // 以降は演算結果の ZDD を出力する
+        }
+
+        PseudoZDD* restricted_zdd = NULL;
+        if (!restrict_list.empty()) {
+            std::vector<int> value_array;
+            MakeRestrictArray(&value_array);
+            restricted_zdd = zdd->Restrict(value_array);
+            zdd = restricted_zdd; // 以降は制限した ZDD を出力する
+        }
+
         if (is_print_pzdd) {
             zdd->OutputZDD(stdout, is_hex); // ZDDを標準出力に出力する
         }
@@ -943,7 +1641,16 @@ public:
         std::cerr << "# of nodes of ZDD = " << number_of_nodes << std::endl;
 
         if (is_reduce) {
-            std::cerr << "# of nodes of reduced ZDD = " << zdd->GetNumberOfNodes() << std::endl;
+            std::cerr << "# of nodes of reduced ZDD = " << number_of_reduced_nodes << std::endl;
+        }
+
+        if (applied_zdd != NULL) {
+            std::cerr << "# of nodes of applied ZDD = " << applied_zdd->GetNumberOfNodes()
+                      << std::endl;
+        }
+
+        if (restricted_zdd != NULL) {
+            std::cerr << "# of nodes of restricted ZDD = " << zdd->GetNumberOfNodes() << std::endl;
         }
 
         if (is_compute_solution || is_sample) {
@@ -960,6 +1667,16 @@ public:
             case GMP:
                 NumPrinter::PrintNumberOfSolutions<MpInt>(zdd, is_compute_solution, false);
                 break;
+            case MODULAR:
+                if (is_compute_solution) {
+                    NumPrinter::PrintNumber(zdd->ComputeNumberOfSolutionsByCRT());
+                }
+                break;
+            case ADAPTIVE:
+                if (is_compute_solution) {
+                    NumPrinter::PrintNumber(zdd->ComputeNumberOfSolutionsAdaptively());
+                }
+                break;
             default:
 #ifdef HAVE_LIBGMPXX
                 NumPrinter::PrintNumberOfSolutions<MpInt>(zdd, is_compute_solution, false);
@@ -970,6 +1687,64 @@ public:
             }
         }
 
+        if (dist_kind != DIST_NONE) {
+            switch (precision_kind) {
+            case INTX:
+                OutputDistribution<uintx>(zdd);
+                break;
+            case DOUBLE:
+                OutputDistribution<double>(zdd);
+                break;
+            case BIGINT:
+                OutputDistribution<BigInteger>(zdd);
+                break;
+            case GMP:
+                OutputDistribution<MpInt>(zdd);
+                break;
+            default:
+#ifdef HAVE_LIBGMPXX
+                OutputDistribution<MpInt>(zdd);
+#else
+                OutputDistribution<BigInteger>(zdd);
+#endif
+                break;
+            }
+        }
+
+        if (is_marginal) {
+            switch (precision_kind) {
+            case INTX:
+                OutputMarginals<uintx>(zdd);
+                break;
+            case DOUBLE:
+                OutputMarginals<double>(zdd);
+                break;
+            case BIGINT:
+                OutputMarginals<BigInteger>(zdd);
+                break;
+            case GMP:
+                OutputMarginals<MpInt>(zdd);
+                break;
+            default:
+#ifdef HAVE_LIBGMPXX
+                OutputMarginals<MpInt>(zdd);
+#else
+                OutputMarginals<BigInteger>(zdd);
+#endif
+                break;
+            }
+        }
+
+        if (is_reliability) {
+            std::vector<std::vector<double> > probability_matrix;
+            int number_of_scenarios = ReadProbabilityMatrix(&probability_matrix);
+            std::vector<double> result;
+            zdd->ComputeReliabilities(probability_matrix, number_of_scenarios, &result);
+            for (int s = 0; s < number_of_scenarios; ++s) {
+                std::cout << std::setprecision(15) << result[s] << std::endl;
+            }
+        }
+
         if (is_enum) {
             if (enum_filename == "") {
                 std::cerr << "Please input a filename for enum." << std::endl;
@@ -987,19 +1762,27 @@ public:
             }
         }
 
+        if (opt_kind != OPT_NONE) {
+            OutputOptimalSolutions(zdd);
+        }
+
+        if (is_pareto) {
+            OutputParetoSolutions(zdd);
+        }
+
         if (is_sample) {
             if (sample_filename == "") {
                 std::cerr << "Please input a filename for sample." << std::endl;
                 exit(1);
             } else if (sample_filename == "-") {
-                zdd->OutputSamplingSolutions(stdout, sample_num); // random sampling
+                OutputSamples(zdd, stdout);
             } else {
                 FILE* fout = fopen(sample_filename.c_str(), "w");
                 if (fout == NULL) {
                     std::cerr << "file open error!" << std::endl;
                     exit(1);
                 }
-                zdd->OutputSamplingSolutions(fout, sample_num); // random sampling
+                OutputSamples(zdd, fout);
                 fclose(fout);
             }
         }
@@ -1019,6 +1802,9 @@ public:
         //        //am->PrintForGraphviz(); // Graphviz 用出力
         //    }
         //}
+
+        delete restricted_zdd;
+        delete applied_zdd;
     }
 
     template<typename T>
@@ -60,6 +60,9 @@ int StateCombination::CheckTerminalPost(MateCombination* mate)
         } else {
             return 0;
         }
+    } else if (mate->data + GetRestWeight() < number_of_edges_range_.first) {
+        // 残りの辺をすべて選んでも下限に届かない
+        return 0;
     } else {
         return -1;
     }
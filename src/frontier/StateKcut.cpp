@@ -98,6 +98,35 @@ int StateKcut::CheckTerminalPost(MateKcut* mate)
             return 1;
         }
     } else {
+        // 残りの辺をすべてカットしても下限に届かない
+        if (mate->data.cut_weight + GetRestWeight() < elimit_.first) {
+            return 0;
+        }
+        // 連結成分数は減らないので、既に上限を超えていれば以後も超える
+        if (mate->data.number_of_components > component_limit_.second) {
+            return 0;
+        }
+        // 連結成分数の最大値は、確定した成分数と、フロンティア上の成分数と、
+        // まだ現れていない頂点数の和である
+        int max_components = mate->data.number_of_components
+            + rest_vertex_array_[current_edge_ + 1];
+        for (int i = 0; i < frontier_manager_.GetNextFrontierSize(); ++i) {
+            mate_t v = frontier_manager_.GetNextFrontierValue(i);
+            bool is_exist = false;
+            for (int j = 0; j < i; ++j) {
+                if (mate->frontier[v].comp
+                    == mate->frontier[frontier_manager_.GetNextFrontierValue(j)].comp) {
+                    is_exist = true;
+                    break;
+                }
+            }
+            if (!is_exist) {
+                ++max_components;
+            }
+        }
+        if (max_components < component_limit_.first || max_components <= 1) {
+            return 0;
+        }
         return -1;
     }
 }
@@ -54,11 +54,33 @@ protected:
     typedef MateFD<FrontierComp, MateConfKcut> MateKcut;
     std::pair<int, int> elimit_;
     std::pair<short, short> component_limit_;
+    // rest_vertex_array_[i]: 辺 i 以降で初めて現れる頂点の数
+    std::vector<int> rest_vertex_array_;
 
 public:
     StateKcut(Graph* graph, std::pair<int, int> edge_weight_limit,
               std::pair<short, short> component_limit) : StateFrontierComp<MateKcut>(graph),
-                  elimit_(edge_weight_limit), component_limit_(component_limit) { }
+                  elimit_(edge_weight_limit), component_limit_(component_limit)
+    {
+        std::vector<bool> appeared_array(number_of_vertices_ + 1, false);
+        std::vector<int> first_count_array(number_of_edges_ + 1, 0);
+        for (int i = 0; i < number_of_edges_; ++i) {
+            const Edge& edge = graph->GetEdge(i);
+            if (!appeared_array[edge.src]) {
+                appeared_array[edge.src] = true;
+                ++first_count_array[i];
+            }
+            if (!appeared_array[edge.dest]) {
+                appeared_array[edge.dest] = true;
+                ++first_count_array[i];
+            }
+        }
+        rest_vertex_array_.resize(number_of_edges_ + 1);
+        rest_vertex_array_[number_of_edges_] = 0;
+        for (int i = number_of_edges_ - 1; i >= 0; --i) {
+            rest_vertex_array_[i] = rest_vertex_array_[i + 1] + first_count_array[i];
+        }
+    }
 
     virtual ~StateKcut() { }
 
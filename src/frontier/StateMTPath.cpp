@@ -95,9 +95,34 @@ int StateMTPath::CheckTerminalPost(MateMTPath* mate)
 
     if (IsLastEdge()) {
         return 1;
+    } else if (IsLookahead() && !CheckLookahead(mate)) {
+        return 0;
     } else {
         return -1;
     }
 }
 
+// 残りグラフを先読みし、解に到達できないことがわかった場合は false を返す。
+// 次数 0 のヒント頂点と次数 1 のヒント頂点でない頂点がパスの端点となる。
+bool StateMTPath::CheckLookahead(MateMTPath* mate)
+{
+    const TerminalManager& tm = GetTerminalManager();
+
+    kind_array_.resize(frontier_manager_.GetNextFrontierSize());
+    for (int i = 0; i < frontier_manager_.GetNextFrontierSize(); ++i) {
+        mate_t v = frontier_manager_.GetNextFrontierValue(i);
+        if (mate->frontier[v] == 0) { // v の次数が 2
+            kind_array_[i] = RestGraphManager::SATURATED;
+        } else if (tm.Exists(v)) { // v がヒント頂点
+            kind_array_[i] = (mate->frontier[v] == v ? RestGraphManager::ENDPOINT
+                              : RestGraphManager::SATURATED);
+        } else {
+            kind_array_[i] = (mate->frontier[v] == v ? RestGraphManager::ISOLATED
+                              : RestGraphManager::ENDPOINT);
+        }
+    }
+    return rest_graph_manager_.CheckDegree(kind_array_, (IsHamilton() ? 2 : 0))
+        && rest_graph_manager_.CheckPairing(kind_array_, IsHamilton(), false);
+}
+
 } // the end of the namespace
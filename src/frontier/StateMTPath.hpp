@@ -96,9 +96,21 @@ public:
         terminal_manager_.Parse(filename);
     }
 
+    virtual Mate* Initialize(ZDDNode* root_node)
+    {
+        // ヒント頂点は未処理の間は端点として扱う
+        for (int v = 1; v <= number_of_vertices_; ++v) {
+            if (terminal_manager_.Exists(v)) {
+                rest_graph_manager_.SetRequired(v);
+            }
+        }
+        return StatePathMatching::Initialize(root_node);
+    }
+
 protected:
     virtual int CheckTerminalPre(MateMTPath* mate, int child_num);
     virtual int CheckTerminalPost(MateMTPath* mate);
+    virtual bool CheckLookahead(MateMTPath* mate);
 };
 
 } // the end of the namespace
@@ -94,9 +94,33 @@ int StatePathMatching::CheckTerminalPost(MatePathMatching* mate)
 
     if (IsLastEdge()) {
         return 1;
+    } else if (IsLookahead() && !CheckLookahead(mate)) {
+        return 0;
     } else {
         return -1;
     }
 }
 
+// 残りグラフを先読みし、解に到達できないことがわかった場合は false を返す。
+// パスはどの頂点で終わってもよいので、ハミルトンパスの場合に
+// 次数 0 の頂点に辺を接続できるかどうかのみ調べる。
+bool StatePathMatching::CheckLookahead(MatePathMatching* mate)
+{
+    if (!IsHamilton()) {
+        return true;
+    }
+    kind_array_.resize(frontier_manager_.GetNextFrontierSize());
+    for (int i = 0; i < frontier_manager_.GetNextFrontierSize(); ++i) {
+        mate_t v = frontier_manager_.GetNextFrontierValue(i);
+        if (mate->frontier[v] == 0) { // v の次数が 2
+            kind_array_[i] = RestGraphManager::SATURATED;
+        } else if (mate->frontier[v] == v) { // v の次数が 0 （辺を 1 本以上接続する必要がある）
+            kind_array_[i] = RestGraphManager::ENDPOINT;
+        } else { // v の次数が 1 （これ以上辺を接続しなくてもよい）
+            kind_array_[i] = RestGraphManager::ISOLATED;
+        }
+    }
+    return rest_graph_manager_.CheckDegree(kind_array_, 0);
+}
+
 } // the end of the namespace
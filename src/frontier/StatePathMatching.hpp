@@ -24,6 +24,7 @@
 #include "../frontier_lib/StateFrontier.hpp"
 #include "../frontier_lib/PseudoZDD.hpp"
 #include "../frontier_lib/MatePrinter.hpp"
+#include "../frontier_lib/RestGraphManager.hpp"
 
 namespace frontier_lib {
 
@@ -33,9 +34,14 @@ class StatePathMatching : public StateFrontier<MateF<mate_t> >  {
 protected:
     typedef MateF<mate_t> MatePathMatching;
     bool is_hamilton_;
+    bool is_lookahead_; // 残りグラフの先読みによる枝刈りを行うか
+
+    RestGraphManager rest_graph_manager_;
+    std::vector<int> kind_array_; // 先読みで用いるフロンティアの頂点の種類
 
 public:
-    StatePathMatching(Graph* graph) : StateFrontier<MatePathMatching>(graph), is_hamilton_(false) { }
+    StatePathMatching(Graph* graph) : StateFrontier<MatePathMatching>(graph), is_hamilton_(false),
+                                      is_lookahead_(false), rest_graph_manager_(graph) { }
     virtual ~StatePathMatching() { }
 
     bool IsHamilton() const
@@ -48,6 +54,25 @@ public:
         is_hamilton_ = is_hamilton;
     }
 
+    bool IsLookahead() const
+    {
+        return is_lookahead_;
+    }
+
+    void SetLookahead(bool is_lookahead)
+    {
+        is_lookahead_ = is_lookahead;
+    }
+
+    virtual void StartNextEdge()
+    {
+        StateFrontier<MatePathMatching>::StartNextEdge();
+
+        if (IsLookahead()) {
+            rest_graph_manager_.Update(current_edge_, frontier_manager_);
+        }
+    }
+
     virtual void UnpackMate(ZDDNode* node, Mate* mate, int child_num);
 
     virtual std::string GetString(Mate* mate, bool next) const
@@ -61,6 +86,7 @@ protected:
     virtual void UpdateMate(MatePathMatching* mate, int child_num);
     virtual int CheckTerminalPre(MatePathMatching* mate, int child_num);
     virtual int CheckTerminalPost(MatePathMatching* mate);
+    virtual bool CheckLookahead(MatePathMatching* mate);
 };
 
 } // the end of the namespace
@@ -95,6 +95,10 @@ int StateRcut::CheckTerminalPost(MateRcut* mate)
             return 1;
         }
     } else {
+        // 残りの辺をすべてカットしても下限に届かない
+        if (mate->data.cut_weight + GetRestWeight() < elimit_.first) {
+            return 0;
+        }
         for (int i = 0; i < frontier_manager_.GetLeavingFrontierSize(); ++i) {
             // フロンティアから抜ける頂点
             mate_t v = frontier_manager_.GetLeavingFrontierValue(i);
@@ -161,9 +161,32 @@ int StateSTPath::CheckTerminalPost(MateSTPath* mate)
     }
     if (IsLastEdge()) {
         return 0;
+    } else if (IsLookahead() && !CheckLookahead(mate)) {
+        return 0;
     } else {
         return -1;
     }
 }
 
+// 残りグラフを先読みし、解に到達できないことがわかった場合は false を返す。
+// 次数 1 の頂点（未処理の s, t を含む）はパスの端点であり、残りグラフの
+// 各連結成分の中で端点どうしを対にしてつなぐ必要がある。
+bool StateSTPath::CheckLookahead(MateSTPath* mate)
+{
+    kind_array_.resize(frontier_manager_.GetNextFrontierSize());
+    for (int i = 0; i < frontier_manager_.GetNextFrontierSize(); ++i) {
+        mate_t v = frontier_manager_.GetNextFrontierValue(i);
+        if (mate->frontier[v] == 0) { // v の次数が 2
+            kind_array_[i] = RestGraphManager::SATURATED;
+        } else if (mate->frontier[v] == v) { // v の次数が 0
+            kind_array_[i] = RestGraphManager::ISOLATED;
+        } else { // v の次数が 1
+            kind_array_[i] = RestGraphManager::ENDPOINT;
+        }
+    }
+    // ハミルトンパス、サイクルの場合、次数 0 の頂点には辺を 2 本接続する必要がある
+    return rest_graph_manager_.CheckDegree(kind_array_, (IsHamilton() ? 2 : 0))
+        && rest_graph_manager_.CheckPairing(kind_array_, IsHamilton(), IsCycle());
+}
+
 } // the end of the namespace
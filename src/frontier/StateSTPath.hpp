@@ -24,6 +24,7 @@
 #include "../frontier_lib/StateFrontier.hpp"
 #include "../frontier_lib/PseudoZDD.hpp"
 #include "../frontier_lib/MatePrinter.hpp"
+#include "../frontier_lib/RestGraphManager.hpp"
 
 namespace frontier_lib {
 
@@ -39,15 +40,20 @@ protected:
     bool is_cycle_; // s-t パスではなくてサイクルにするか（true の場合サイクル）
                     // true の場合、start_vertex_ と end_vertex_ は無視される
     bool st_entering_frontier_; // s or t がフロンティアに入ったかどうかを表す
+    bool is_lookahead_; // 残りグラフの先読みによる枝刈りを行うか
+
+    RestGraphManager rest_graph_manager_;
+    std::vector<int> kind_array_; // 先読みで用いるフロンティアの頂点の種類
 
 public:
-    StateSTPath(Graph* graph) : StateFrontier<MateSTPath>(graph)
+    StateSTPath(Graph* graph) : StateFrontier<MateSTPath>(graph), rest_graph_manager_(graph)
     {
         start_vertex_ = 1;
         end_vertex_ = graph->GetNumberOfVertices();
         is_hamilton_ = false;
         is_cycle_ = false;
         st_entering_frontier_ = false;
+        is_lookahead_ = false;
     }
 
     virtual ~StateSTPath() { }
@@ -88,15 +94,40 @@ public:
         is_cycle_ = is_cycle;
     }
 
+    bool IsLookahead() const
+    {
+        return is_lookahead_;
+    }
+
+    void SetLookahead(bool is_lookahead)
+    {
+        is_lookahead_ = is_lookahead;
+    }
+
     bool STEnteringFrontier()
     {
         return st_entering_frontier_;
     }
 
+    virtual Mate* Initialize(ZDDNode* root_node)
+    {
+        // s == t のときは s を通るサイクルを数えるので、s は端点ではない
+        if (!IsCycle() && start_vertex_ != end_vertex_) {
+            // s と t は初めからつながれていると考えるので、未処理の間は端点として扱う
+            rest_graph_manager_.SetRequired(start_vertex_);
+            rest_graph_manager_.SetRequired(end_vertex_);
+        }
+        return StateFrontier<MateSTPath>::Initialize(root_node);
+    }
+
     virtual void StartNextEdge()
     {
         StateFrontier<MateSTPath>::StartNextEdge();
 
+        if (IsLookahead()) {
+            rest_graph_manager_.Update(current_edge_, frontier_manager_);
+        }
+
         if (!st_entering_frontier_) {
             if (frontier_manager_.FindInEnteringFrontier(start_vertex_)) {
                 st_entering_frontier_ = true;
@@ -120,6 +151,7 @@ protected:
     virtual void UpdateMate(MateSTPath* mate, int child_num);
     virtual int CheckTerminalPre(MateSTPath* mate, int child_num);
     virtual int CheckTerminalPost(MateSTPath* mate);
+    bool CheckLookahead(MateSTPath* mate);
 };
 
 
@@ -20,6 +20,7 @@
 
 #include <cstring>
 #include <cassert>
+#include <algorithm>
 
 #include "StateSTPathDist.hpp"
 
@@ -100,8 +101,13 @@ int StateSTPathDist::CheckTerminalPre(MateSTPathDist* mate, int child_num)
         if (mate->data + edge.weight > elimit_.second) {
             return 0;
         }
+        // 重み elimit_.second 以下のどの s-t パスにも含まれない辺
+        if (!IsCycle() && !usable_edge_array_[current_edge_]) {
+            return 0;
+        }
     }
-    
+
+
     if (child_num == 0) { // Lo枝のとき
         return -1;
     } else { // Hi枝のとき
@@ -170,9 +176,92 @@ int StateSTPathDist::CheckTerminalPost(MateSTPathDist* mate)
     }
     if (IsLastEdge()) {
         return 0;
+    } else if (!IsCycle() && !IsFeasibleDistance(mate)) {
+        return 0;
     } else {
         return -1;
     }
 }
 
+// s, t からの最短距離などを前計算する。
+void StateSTPathDist::PrepareDistance()
+{
+    graph_->ComputeShortestDistance(start_vertex_, &start_dist_array_);
+    graph_->ComputeShortestDistance(end_vertex_, &end_dist_array_);
+
+    // distfilter と同じ判定を辺ごとに行う。
+    // 辺 (u, v) を通る s-t パスの重みは d(s, u) + w + d(v, t) 以上である。
+    usable_edge_array_.resize(number_of_edges_);
+    for (int i = 0; i < number_of_edges_; ++i) {
+        const Edge& edge = graph_->GetEdge(i);
+        int d = min(start_dist_array_[edge.src] + end_dist_array_[edge.dest],
+                    start_dist_array_[edge.dest] + end_dist_array_[edge.src]);
+        usable_edge_array_[i] = (d + edge.weight <= elimit_.second);
+    }
+
+    start_first_edge_ = number_of_edges_;
+    end_first_edge_ = number_of_edges_;
+    for (int i = number_of_edges_ - 1; i >= 0; --i) {
+        const Edge& edge = graph_->GetEdge(i);
+        if (edge.src == start_vertex_ || edge.dest == start_vertex_) {
+            start_first_edge_ = i;
+        }
+        if (edge.src == end_vertex_ || edge.dest == end_vertex_) {
+            end_first_edge_ = i;
+        }
+    }
+}
+
+// mate update 後に、重みが elimit_ の範囲に入る s-t パスを作れる可能性があるかを判定する。
+// s と t を仮想的な辺で結んだとき、処理済みの辺はいくつかのパスの断片になり、
+// 未処理の辺からなる経路が断片の端点同士を2つずつ結ぶ。端点 p, q を結ぶ経路の重みは
+// |d(p, t) - d(q, t)| 以上なので、d(・, t) の値をソートして隣どうしを組にした差の和が
+// 残りの重みの下界になる（d(・, s) についても同様）。
+bool StateSTPathDist::IsFeasibleDistance(MateSTPathDist* mate)
+{
+    // 残りの辺をすべて使っても下限に届かない
+    if (mate->data + GetRestWeight() < elimit_.first) {
+        return false;
+    }
+
+    endpoint_start_dist_array_.clear();
+    endpoint_end_dist_array_.clear();
+
+    for (int i = 0; i < frontier_manager_.GetNextFrontierSize(); ++i) {
+        mate_t v = frontier_manager_.GetNextFrontierValue(i);
+        if (mate->frontier[v] != 0 && mate->frontier[v] != v) { // 断片の端点
+            endpoint_start_dist_array_.push_back(start_dist_array_[v]);
+            endpoint_end_dist_array_.push_back(end_dist_array_[v]);
+        }
+    }
+    // まだフロンティアに入っていない s, t は仮想的な辺 (s, t) の端点
+    if (current_edge_ < start_first_edge_) {
+        endpoint_start_dist_array_.push_back(0);
+        endpoint_end_dist_array_.push_back(end_dist_array_[start_vertex_]);
+    }
+    if (current_edge_ < end_first_edge_) {
+        endpoint_start_dist_array_.push_back(start_dist_array_[end_vertex_]);
+        endpoint_end_dist_array_.push_back(0);
+    }
+
+    for (size_t i = 0; i < endpoint_start_dist_array_.size(); ++i) {
+        if (endpoint_start_dist_array_[i] == Graph::INFINITE_DISTANCE
+            || endpoint_end_dist_array_[i] == Graph::INFINITE_DISTANCE) { // s, t に到達できない
+            return false;
+        }
+    }
+
+    sort(endpoint_start_dist_array_.begin(), endpoint_start_dist_array_.end());
+    sort(endpoint_end_dist_array_.begin(), endpoint_end_dist_array_.end());
+
+    int start_bound = 0;
+    int end_bound = 0;
+    for (size_t i = 0; i + 1 < endpoint_start_dist_array_.size(); i += 2) {
+        start_bound += endpoint_start_dist_array_[i + 1] - endpoint_start_dist_array_[i];
+        end_bound += endpoint_end_dist_array_[i + 1] - endpoint_end_dist_array_[i];
+    }
+
+    return mate->data + max(start_bound, end_bound) <= elimit_.second;
+}
+
 } // the end of the namespace
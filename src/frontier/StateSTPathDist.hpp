@@ -42,6 +42,16 @@ protected:
 
     std::pair<int, int> elimit_;
 
+    // 距離による枝刈りのための前計算（サイクルの場合は使わない）
+    std::vector<int> start_dist_array_; // s から各頂点への最短距離
+    std::vector<int> end_dist_array_; // t から各頂点への最短距離
+    std::vector<bool> usable_edge_array_; // 重み elimit_.second 以下の s-t パスに含まれうる辺
+    int start_first_edge_; // s に接続する最初の辺の番号
+    int end_first_edge_; // t に接続する最初の辺の番号
+
+    std::vector<int> endpoint_start_dist_array_; // 作業用
+    std::vector<int> endpoint_end_dist_array_; // 作業用
+
 public:
     StateSTPathDist(Graph* graph) : StateFrontier<MateSTPathDist>(graph)
     {
@@ -124,6 +134,9 @@ public:
         MateSTPathDist* mate = static_cast<MateSTPathDist*>(StateFrontier<MateSTPathDist>::Initialize(root_node));
         int initial_value = 0;
         mate->Initialize(root_node, initial_value);
+        if (!IsCycle()) {
+            PrepareDistance();
+        }
         return mate;
     }
 
@@ -144,6 +157,10 @@ protected:
     virtual void UpdateMate(MateSTPathDist* mate, int child_num);
     virtual int CheckTerminalPre(MateSTPathDist* mate, int child_num);
     virtual int CheckTerminalPost(MateSTPathDist* mate);
+
+private:
+    void PrepareDistance();
+    bool IsFeasibleDistance(MateSTPathDist* mate);
 };
 
 
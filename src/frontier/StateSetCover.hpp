@@ -29,10 +29,15 @@ namespace frontier_lib {
 // StateSetCover: 集合被覆のための State
 class StateSetCover : public StateSetPartition {
 protected:
-    typedef MateF<byte> MateSetCover;
+    typedef MateBit MateSetCover;
 
 public:
-    StateSetCover(HyperGraph* graph) : StateSetPartition(graph) { }
+    // 集合被覆では要素を重複して被覆してよいので、フロンティア上の要素は
+    // それを含む未処理のハイパー辺によって常に被覆できる。したがって先読みは行わない。
+    StateSetCover(HyperGraph* graph) : StateSetPartition(graph)
+    {
+        is_lookahead_ = false;
+    }
     virtual ~StateSetCover() { }
 
 protected:
@@ -29,10 +29,14 @@ namespace frontier_lib {
 // StateSetPacking: 集合パッキングのための State
 class StateSetPacking : public StateSetPartition {
 protected:
-    typedef MateF<byte> MateSetPacking;
+    typedef MateBit MateSetPacking;
 
 public:
-    StateSetPacking(HyperGraph* graph) : StateSetPartition(graph) { }
+    // 集合パッキングでは要素を被覆する必要がないので、先読みは行わない
+    StateSetPacking(HyperGraph* graph) : StateSetPartition(graph)
+    {
+        is_lookahead_ = false;
+    }
     virtual ~StateSetPacking() { }
 
 protected:
@@ -27,24 +27,62 @@ using namespace std;
 //*************************************************************************************************
 // StateSetPartition
 
-void StateSetPartition::UnpackMate(ZDDNode* node, Mate* mate, int child_num)
+void StateSetPartition::StartNextEdge()
 {
-    StateFrontierHyper<MateSetPartition>::UnpackMate(node, mate, child_num);
+    StateFrontierHyper<MateSetPartition>::StartNextEdge();
 
-    MateSetPartition* m = static_cast<MateSetPartition*>(mate);
+    for (int i = 0; i < frontier_manager_.GetPreviousFrontierSize(); ++i) {
+        position_array_[frontier_manager_.GetPreviousFrontierValue(i)] = -1;
+    }
+    for (int i = 0; i < frontier_manager_.GetBothFrontierSize(); ++i) {
+        position_array_[frontier_manager_.GetBothFrontierValue(i)] = i;
+    }
+    number_of_words_ = MateBit::GetNumberOfWords(frontier_manager_.GetBothFrontierSize());
+
+    edge_mask_array_.assign(number_of_words_, 0);
+    const HyperEdge& edge = GetCurrentHyperEdge();
+    for (uint i = 0; i < edge.var_array.size(); ++i) {
+        SetMask(edge.var_array[i], &edge_mask_array_[0]);
+    }
+
+    leaving_mask_array_.assign(number_of_words_, 0);
+    for (int i = 0; i < frontier_manager_.GetLeavingFrontierSize(); ++i) {
+        SetMask(frontier_manager_.GetLeavingFrontierValue(i), &leaving_mask_array_[0]);
+    }
 
-    for (int i = 0; i < frontier_manager_.GetEnteringFrontierSize(); ++i) {
-        int v = frontier_manager_.GetEnteringFrontierValue(i);
-        m->frontier[v] = 0;
+    next_mask_array_.assign(number_of_words_, 0);
+    for (int i = 0; i < frontier_manager_.GetNextFrontierSize(); ++i) {
+        SetMask(frontier_manager_.GetNextFrontierValue(i), &next_mask_array_[0]);
     }
+
+    // フロンティアの要素を含む未処理のハイパー辺のビットマスクを求める
+    candidate_mask_array_.clear();
+    if (is_lookahead_) {
+        std::vector<uint64> mask_array(number_of_words_);
+        for (int i = current_edge_ + 1; i < number_of_edges_; ++i) {
+            const HyperEdge& e = hgraph_->GetHyperEdge(i);
+            std::fill(mask_array.begin(), mask_array.end(), 0);
+            bool is_found = false;
+            for (uint j = 0; j < e.var_array.size(); ++j) {
+                if (position_array_[e.var_array[j]] >= 0) {
+                    SetMask(e.var_array[j], &mask_array[0]);
+                    is_found = true;
+                }
+            }
+            if (is_found) {
+                candidate_mask_array_.insert(candidate_mask_array_.end(),
+                                             mask_array.begin(), mask_array.end());
+            }
+        }
+    }
+    coverable_mask_array_.resize(number_of_words_);
 }
 
 void StateSetPartition::UpdateMate(MateSetPartition* mate, int child_num)
 {
     if (child_num == 1) { // Hi枝のとき
-        const HyperEdge& edge = GetCurrentHyperEdge();
-        for (uint i = 0; i < edge.var_array.size(); ++i) {
-            mate->frontier[edge.var_array[i]] = 1;
+        for (int w = 0; w < number_of_words_; ++w) {
+            mate->bits[w] |= edge_mask_array_[w];
         }
     }
 }
@@ -54,9 +92,8 @@ void StateSetPartition::UpdateMate(MateSetPartition* mate, int child_num)
 int StateSetPartition::CheckTerminalPre(MateSetPartition* mate, int child_num)
 {
     if (child_num == 1) { // Hi枝のとき
-        const HyperEdge& edge = GetCurrentHyperEdge();
-        for (uint i = 0; i < edge.var_array.size(); ++i) {
-            if (mate->frontier[edge.var_array[i]] != 0) {
+        for (int w = 0; w < number_of_words_; ++w) {
+            if ((mate->bits[w] & edge_mask_array_[w]) != 0) { // 既に被覆された要素を含む
                 return 0;
             }
         }
@@ -68,18 +105,49 @@ int StateSetPartition::CheckTerminalPre(MateSetPartition* mate, int child_num)
 // 0終端なら 0, 1終端なら 1, どちらでもない場合は -1 を返す。
 int StateSetPartition::CheckTerminalPost(MateSetPartition* mate)
 {
-    for (int i = 0; i < frontier_manager_.GetLeavingFrontierSize(); ++i) {
-        int v = frontier_manager_.GetLeavingFrontierValue(i);
-        if (mate->frontier[v] == 0) {
+    for (int w = 0; w < number_of_words_; ++w) {
+        // フロンティアから抜ける要素が被覆されていない
+        if ((mate->bits[w] & leaving_mask_array_[w]) != leaving_mask_array_[w]) {
             return 0;
         }
     }
 
     if (IsLastEdge()) {
         return 1;
+    } else if (is_lookahead_ && !IsCoverable(mate)) {
+        return 0;
     } else {
         return -1;
     }
 }
 
+// フロンティア上のまだ被覆されていない各要素について、それを含み、
+// かつ既に被覆された要素を含まない未処理のハイパー辺が存在するか調べる。
+bool StateSetPartition::IsCoverable(MateSetPartition* mate)
+{
+    std::fill(coverable_mask_array_.begin(), coverable_mask_array_.end(), 0);
+
+    for (uint c = 0; c < candidate_mask_array_.size(); c += number_of_words_) {
+        bool is_dead = false;
+        for (int w = 0; w < number_of_words_; ++w) {
+            if ((mate->bits[w] & candidate_mask_array_[c + w]) != 0) {
+                is_dead = true;
+                break;
+            }
+        }
+        if (!is_dead) {
+            for (int w = 0; w < number_of_words_; ++w) {
+                coverable_mask_array_[w] |= candidate_mask_array_[c + w];
+            }
+        }
+    }
+
+    for (int w = 0; w < number_of_words_; ++w) {
+        if ((next_mask_array_[w] & ~mate->bits[w] & ~coverable_mask_array_[w]) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
 } // the end of the namespace
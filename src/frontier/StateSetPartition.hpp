@@ -30,20 +30,51 @@ namespace frontier_lib {
 
 //*************************************************************************************************
 // StateSetPartition: 集合分割のための State
-class StateSetPartition : public StateFrontierHyper<MateF<byte> > {
+// フロンティアの各要素が被覆済みかどうかを MateBit のビットで表す。
+class StateSetPartition : public StateFrontierHyper<MateBit> {
 protected:
-    typedef MateF<byte> MateSetPartition;
+    typedef MateBit MateSetPartition;
+
+    // 未処理のハイパー辺による被覆可能性の先読みを行うか
+    bool is_lookahead_;
+
+    // position_array_[v]: v の both frontier における位置（フロンティア上にないときは -1）
+    std::vector<int> position_array_;
+    // both frontier の要素を格納するのに必要なワード数
+    int number_of_words_;
+    // 現在のハイパー辺に含まれる要素のビットマスク
+    std::vector<uint64> edge_mask_array_;
+    // フロンティアから抜ける要素のビットマスク
+    std::vector<uint64> leaving_mask_array_;
+    // フロンティアに残る要素のビットマスク
+    std::vector<uint64> next_mask_array_;
+    // フロンティアの要素を含む未処理のハイパー辺のビットマスクを
+    // number_of_words_ ワードずつ並べた配列
+    std::vector<uint64> candidate_mask_array_;
+    // 作業用配列。採用可能な未処理のハイパー辺が被覆できる要素のビットマスク
+    std::vector<uint64> coverable_mask_array_;
 
 public:
-    StateSetPartition(HyperGraph* graph) : StateFrontierHyper<MateSetPartition>(graph) { }
+    StateSetPartition(HyperGraph* graph) : StateFrontierHyper<MateSetPartition>(graph),
+                                           is_lookahead_(true),
+                                           position_array_(graph->GetNumberOfVertices() + 1, -1),
+                                           number_of_words_(0) { }
     virtual ~StateSetPartition() { }
 
-    virtual void UnpackMate(ZDDNode* node, Mate* mate, int child_num);
+    virtual void StartNextEdge();
 
 protected:
     virtual void UpdateMate(MateSetPartition* mate, int child_num);
     virtual int CheckTerminalPre(MateSetPartition* mate, int child_num);
     virtual int CheckTerminalPost(MateSetPartition* mate);
+    bool IsCoverable(MateSetPartition* mate);
+
+    // 要素 v のビットを mask_array に立てる
+    void SetMask(int v, uint64* mask_array) const
+    {
+        int pos = position_array_[v];
+        mask_array[pos / MateBit::WORD_BITS] |= static_cast<uint64>(1) << (pos % MateBit::WORD_BITS);
+    }
 };
 
 } // the end of the namespace
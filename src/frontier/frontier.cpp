@@ -37,11 +37,16 @@ int main(int argc, char** argv)
     parser.PrepareGraph();
     parser.MakeState();
 
-    PseudoZDD* zdd = FrontierAlgorithm::Construct(parser.state); // アルゴリズム開始
+    if (parser.eval_kind != OptionParser::EVAL_NONE) {
+        parser.Evaluate(); // ZDD を構築せずに評価する
+    } else {
+        PseudoZDD* zdd = FrontierAlgorithm::Construct(parser.state, parser.hdd_filename,
+                                                      parser.is_reduce_on_the_fly); // アルゴリズム開始
 
-    parser.Output(zdd);
+        parser.Output(zdd);
 
-    delete zdd;
+        delete zdd;
+    }
 
     //muntrace(); // for debug
 
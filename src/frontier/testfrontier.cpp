@@ -20,6 +20,14 @@
 
 #include <cstring>
 #include <utility>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+#include <map>
+#include <set>
+#include <fstream>
+#include <algorithm>
+#include <unistd.h>
 
 #include "../frontier_lib/Global.hpp"
 #include "../frontier_lib/BigInteger.hpp"
@@ -190,6 +198,21 @@ void MakeTestSTPathDistOnRandom(std::vector<std::pair<string, string> >* test_li
     }
 }
 
+void MakeTestSTPathDistOnGrid(std::vector<std::pair<string, string> >* test_list)
+{
+    string result[] = {"1452", "5356", "924", "6864", "0", "3432"};
+
+    const char* elimit_array[] = {"[0,12]", "[10,14]"};
+
+    char ss[1024];
+
+    for (int i = 0; i < 6; ++i) {
+        sprintf(ss, "-t stpath -n --elimit %s --input testdata/grid%dx%d.txt", elimit_array[i % 2], i / 2 + 6, i / 2 + 6);
+
+        test_list->push_back(std::make_pair(string(ss), result[i]));
+    }
+}
+
 void MakeTestMTPathOnRandom(std::vector<std::pair<string, string> >* test_list)
 {
     string result[] = {"0", "3", "11"};
@@ -204,6 +227,32 @@ void MakeTestMTPathOnRandom(std::vector<std::pair<string, string> >* test_list)
 }
 
 
+void MakeTestLookahead(std::vector<std::pair<string, string> >* test_list)
+{
+    // The same numbers as MakeTestHamiltonianPathOnGrid, MakeTestHamiltonianCycleOnGrid
+    // and MakeTestMTPathOnRandom
+    string path_result[] = {"2", "104", "111712"};
+    string cycle_result[] = {"6", "1072", "4638576"};
+    string mtpath_result[] = {"0", "3", "11"};
+
+    char ss[1024];
+
+    for (int i = 0; i < 3; ++i) {
+        sprintf(ss, "-t stpath --hamilton --lookahead -n --input testdata/grid%dx%d.txt", i * 2 + 3, i * 2 + 3);
+        test_list->push_back(std::make_pair(string(ss), path_result[i]));
+
+        sprintf(ss, "-t stpath --cycle --hamilton --lookahead -n --input testdata/grid%dx%d.txt", i * 2 + 4, i * 2 + 4);
+        test_list->push_back(std::make_pair(string(ss), cycle_result[i]));
+
+        sprintf(ss, "-t mtpath --terminal testdata/terminal1.txt --lookahead -n -c --input testdata/random_graph%d.txt", i + 1);
+        test_list->push_back(std::make_pair(string(ss), mtpath_result[i]));
+    }
+
+    // s == t (cycles through s): the same number as without --lookahead
+    test_list->push_back(std::make_pair(string("-t stpath -s 13 -e 13 --lookahead -n --input testdata/grid5x5.txt"), string("9343")));
+}
+
+
 void MakeTestPathMatchingOnRandom(std::vector<std::pair<string, string> >* test_list)
 {
     string result[] = {"80", "404", "4932"};
@@ -257,6 +306,25 @@ void MakeTestRcutOnRandom(std::vector<std::pair<string, string> >* test_list)
     }
 }
 
+// Lower bounds of the total weight close to the total weight of all edges
+// (39 for random_graph2 and 80 for random_graph3)
+void MakeTestWeightLowerBound(std::vector<std::pair<string, string> >* test_list)
+{
+    string kind[] = {"combination --elimit [30,40]", "combination --elimit [70,85]",
+                     "kcut --elimit [30,100]", "kcut --elimit [70,100] --comp [3,6]",
+                     "rcut -f 1 8 --elimit [15,100]", "rcut -f 1 8 --elimit [60,100]"};
+    string result[] = {"89", "214", "89", "197", "14", "46"};
+
+    char ss[1024];
+
+    for (int i = 0; i < 6; ++i) {
+        sprintf(ss, "-t %s -n -c -w testdata/random_graph%d_weight.txt --input testdata/random_graph%d.txt",
+                kind[i].c_str(), i % 2 + 2, i % 2 + 2);
+
+        test_list->push_back(std::make_pair(string(ss), result[i]));
+    }
+}
+
 void MakeTestSetptpkc(std::vector<std::pair<string, string> >* test_list)
 {
     string result[] = {"2", "1", "72", "38", "72", "161"};
@@ -271,6 +339,595 @@ void MakeTestSetptpkc(std::vector<std::pair<string, string> >* test_list)
     }
 }
 
+void MakeTestReduceOnTheFly(std::vector<std::pair<string, string> >* test_list)
+{
+    // The same numbers as MakeTestSTPathOnGrid, MakeTestSForestOnGrid and MakeTestSetptpkc
+    test_list->push_back(std::make_pair(string("-t stpath --reduce-on-the-fly -n --input testdata/grid8x8.txt"),
+                                        string("789360053252")));
+    test_list->push_back(std::make_pair(string("-t sforest --reduce-on-the-fly -n --input testdata/grid6x6.txt"),
+                                        string("181075508242067552")));
+    test_list->push_back(std::make_pair(string("-t setc --reduce-on-the-fly -n -c --input testdata/hyper_graph2.txt"),
+                                        string("161")));
+}
+
+// Create an empty file with a unique name by mkstemp and return the name.
+// The caller must unlink the file.
+string MakeTmpFileNameForTest()
+{
+    char filename[] = "/tmp/testfrontier_XXXXXX";
+    int fd = mkstemp(filename);
+    assert(fd >= 0);
+    close(fd);
+    return string(filename);
+}
+
+void MakeTestHdd(std::vector<std::pair<string, string> >* test_list, const string& hdd_filename)
+{
+    // The same numbers as MakeTestSTPathOnGrid and MakeTestSetptpkc
+    test_list->push_back(std::make_pair("-t stpath -n --hdd " + hdd_filename + " --input testdata/grid6x6.txt",
+                                        string("1262816")));
+    test_list->push_back(std::make_pair("-t setc -n -c --hdd " + hdd_filename + " --input testdata/hyper_graph2.txt",
+                                        string("161")));
+}
+
+void MakeTestEvalCount(std::vector<std::pair<string, string> >* test_list)
+{
+    // The same numbers as MakeTestSTPathOnGrid, MakeTestSForestOnGrid and MakeTestSetptpkc
+    test_list->push_back(std::make_pair(string("-t stpath --eval count --input testdata/grid8x8.txt"),
+                                        string("789360053252")));
+    test_list->push_back(std::make_pair(string("-t sforest --eval count --input testdata/grid6x6.txt"),
+                                        string("181075508242067552")));
+    test_list->push_back(std::make_pair(string("-t setpt --eval count -c --input testdata/hyper_graph2.txt"),
+                                        string("1")));
+}
+
+void MakeTestModular(std::vector<std::pair<string, string> >* test_list)
+{
+    // The same numbers as MakeTestSTPathOnGrid and MakeTestSForestOnGrid
+    test_list->push_back(std::make_pair(string("-t stpath --smod -n --input testdata/grid8x8.txt"),
+                                        string("789360053252")));
+    test_list->push_back(std::make_pair(string("-t sforest --smod -n --input testdata/grid7x7.txt"),
+                                        string("1315927389374152034113856")));
+}
+
+void MakeTestAdaptive(std::vector<std::pair<string, string> >* test_list)
+{
+    // The same numbers as MakeTestSTPathOnGrid and MakeTestSForestOnGrid
+    test_list->push_back(std::make_pair(string("-t stpath --sv -n --input testdata/grid8x8.txt"),
+                                        string("789360053252")));
+    test_list->push_back(std::make_pair(string("-t sforest --sv -n --input testdata/grid9x9.txt"),
+                                        string("178135975585132088643635627145305047963624")));
+}
+
+void MakeTestDistribution(std::vector<std::pair<string, string> >* test_list)
+{
+    // "k:c" means that there are c solutions consisting of k edges
+    test_list->push_back(std::make_pair(string("-t combination -c --dist size - --input testdata/random_graph1.txt"),
+                                        string("0:1 1:7 2:21 3:35 4:35 5:21 6:7 7:1")));
+    test_list->push_back(std::make_pair(string("-t stpath --dist size - --input testdata/grid4x4.txt"),
+                                        string("6:20 8:36 10:48 12:48 14:32")));
+}
+
+void MakeTestMarginal(std::vector<std::pair<string, string> >* test_list)
+{
+    // the i-th number is the number of solutions including edge i
+    test_list->push_back(std::make_pair(string("-t stpath --marginal - --input testdata/grid3x3.txt"),
+                                        string("6 6 5 5 5 5 5 5 5 6 5 6")));
+    test_list->push_back(std::make_pair(string("-t combination --elimit 3 -c -r --marginal - --input testdata/random_graph1.txt"),
+                                        string("15 15 15 15 15 15 15")));
+}
+
+void MakeTestRestrict(std::vector<std::pair<string, string> >* test_list)
+{
+    // checked by filtering the output of --enum
+    test_list->push_back(std::make_pair(string("-t stpath --restrict 3,5 --input testdata/grid4x4.txt"),
+                                        string("49")));
+    test_list->push_back(std::make_pair(string("-t stpath -r --restrict 10,12,-1 --input testdata/grid4x4.txt"),
+                                        string("9")));
+    test_list->push_back(std::make_pair(string("-t combination -c --restrict -1,-2,-3,-4,-5,-6,-7 --input testdata/random_graph1.txt"),
+                                        string("1")));
+}
+
+// Convert integer to a decimal string in the same way as GetString without 128-bit integers
+string GetStringByBigDecimalForTest(const BigInteger& integer)
+{
+    BigDecimal d;
+    for (int i = integer.GetNumberOfPlaces() - 1; i >= 0; --i) {
+        for (int j = 0; j < 64; ++j) { // compute d * 2^64
+            BigDecimal d2 = d;
+            d += d2;
+        }
+        BigDecimal d3;
+        d3 = integer.GetPlace(i);
+        d += d3;
+    }
+    return d.GetString();
+}
+
+#ifdef __SIZEOF_INT128__
+// Convert integer to a decimal string by dividing it by 10^19 repeatedly (quadratic time)
+string GetStringByDivisionForTest(const BigInteger& integer)
+{
+    const uint64 base = 10000000000000000000ull;
+    std::vector<uint64> place_array;
+    for (int i = 0; i < integer.GetNumberOfPlaces(); ++i) {
+        place_array.push_back(integer.GetPlace(i));
+    }
+    std::vector<uint64> dec;
+    do {
+        unsigned __int128 r = 0;
+        for (int i = static_cast<int>(place_array.size()) - 1; i >= 0; --i) {
+            unsigned __int128 v = (r << 64) | place_array[i];
+            place_array[i] = static_cast<uint64>(v / base);
+            r = v % base;
+        }
+        dec.push_back(static_cast<uint64>(r));
+        while (!place_array.empty() && place_array.back() == 0) {
+            place_array.pop_back();
+        }
+    } while (!place_array.empty());
+
+    std::ostringstream oss;
+    oss << dec.back();
+    for (int i = static_cast<int>(dec.size()) - 2; i >= 0; --i) {
+        oss << std::setw(19) << std::setfill('0') << dec[i];
+    }
+    return oss.str();
+}
+#endif
+
+// Make an integer of n limbs. kind 0: random limbs, 1: all-ones limbs, 2: 2^(64 * (n - 1)).
+BigInteger MakeIntegerForTest(int n, int kind, Random64* random)
+{
+    BigInteger integer;
+    for (int i = 0; i < n; ++i) {
+        uint64 value = 0;
+        if (kind == 0) {
+            value = random->Next();
+        } else if (kind == 1) {
+            value = ~0ull;
+        } else if (i == n - 1) {
+            value = 1;
+        }
+        integer.Set(i, value);
+    }
+    return integer;
+}
+
+// GetString converts by divide and conquer with Karatsuba multiplication when 128-bit integers
+// are available. Compare it with the conversion by BigDecimal, which is too slow for thousands of
+// limbs, so large integers are compared with the conversion by repeated division.
+void TestBigIntegerString()
+{
+    Random64 random(2016);
+    int small_size_array[] = {1, 2, 3, 31, 32, 33, 63, 64, 65, 100, 128, 129};
+    for (int i = 0; i < 12; ++i) {
+        for (int kind = 0; kind < 3; ++kind) {
+            BigInteger integer = MakeIntegerForTest(small_size_array[i], kind, &random);
+            assert(integer.GetString() == GetStringByBigDecimalForTest(integer));
+        }
+    }
+    // zero and the limbs above the highest nonzero limb
+    BigInteger integer = MakeIntegerForTest(40, 2, &random);
+    integer.Set(39, 0);
+    assert(integer.GetString() == "0");
+    integer.Set(0, 12345);
+    assert(integer.GetString() == "12345");
+
+#ifdef __SIZEOF_INT128__
+    int large_size_array[] = {255, 256, 257, 1000, 1023, 1024, 1025, 2047, 2048, 2049, 3000};
+    for (int i = 0; i < 11; ++i) {
+        for (int kind = 0; kind < 3; ++kind) {
+            BigInteger integer = MakeIntegerForTest(large_size_array[i], kind, &random);
+            assert(integer.GetString() == GetStringByDivisionForTest(integer));
+        }
+    }
+    for (int i = 0; i < 20; ++i) {
+        int n = static_cast<int>(random.Next() % 3000) + 1;
+        BigInteger integer = MakeIntegerForTest(n, 0, &random);
+        assert(integer.GetString() == GetStringByDivisionForTest(integer));
+    }
+#endif
+}
+
+// When every edge is used with probability 1/2, the probability is (# of solutions) / 2^m.
+void TestReliability()
+{
+    OptionParser* parser = new OptionParser;
+    parser->ParseCommandLine(string("-t stpath -r --input testdata/grid4x4.txt"));
+    parser->PrepareGraph();
+    parser->MakeState();
+    PseudoZDD* zdd = FrontierAlgorithm::Construct(parser->state);
+    zdd->ReduceAsZDD();
+
+    int m = parser->igraph->GetNumberOfEdges();
+    std::vector<std::vector<double> > probability_matrix(m, std::vector<double>(3));
+    for (int i = 0; i < m; ++i) {
+        probability_matrix[i][0] = 0.5;
+        probability_matrix[i][1] = 0.0;
+        probability_matrix[i][2] = 1.0;
+    }
+    std::vector<double> result;
+    zdd->ComputeReliabilities(probability_matrix, 3, &result);
+    assert(std::fabs(result[0] - 184.0 / (1 << 24)) < 1e-15);
+    assert(result[1] == 0.0 && result[2] == 0.0);
+
+    delete zdd;
+    delete parser;
+}
+
+PseudoZDD* ConstructForTest(const string& line)
+{
+    OptionParser* parser = new OptionParser;
+    parser->ParseCommandLine(line);
+    parser->PrepareGraph();
+    parser->MakeState();
+    PseudoZDD* zdd = FrontierAlgorithm::Construct(parser->state);
+    delete parser;
+    return zdd;
+}
+
+// Read everything written to fp, which is opened by tmpfile(), and close it
+string ReadTmpFileForTest(FILE* fp)
+{
+    rewind(fp);
+    string text;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) {
+        text.append(buf, n);
+    }
+    fclose(fp);
+    return text;
+}
+
+// Write zdd in the format of OutputZDD and import it again as --subset does
+PseudoZDD* ReimportZDDForTest(PseudoZDD* zdd)
+{
+    FILE* fp = tmpfile();
+    assert(fp != NULL);
+    zdd->OutputZDD(fp, false);
+
+    std::istringstream iss(ReadTmpFileForTest(fp));
+    PseudoZDD* imported_zdd = new PseudoZDD;
+    imported_zdd->ImportZDD(iss, false);
+    return imported_zdd;
+}
+
+string CountWithSubsettingForTest(const string& line, PseudoZDD* subsetting_dd)
+{
+    OptionParser* parser = new OptionParser;
+    parser->ParseCommandLine(line);
+    parser->PrepareGraph();
+    parser->MakeState();
+    parser->state->SetSubsettingDD(subsetting_dd);
+    PseudoZDD* zdd = FrontierAlgorithm::Construct(parser->state);
+    string result = zdd->ComputeNumberOfSolutions<BigInteger>().GetString();
+    delete zdd;
+    delete parser;
+    return result;
+}
+
+// Reduce the ZDD written by --hdd (as -r --hdd does) and compare it with the ZDD reduced in memory.
+// The numbers are the same as MakeTestHdd.
+void TestHddReduce()
+{
+    string line_array[] = {"-t stpath --input testdata/grid6x6.txt",
+                           "-t setc -c --input testdata/hyper_graph2.txt"};
+    string result_array[] = {"1262816", "161"};
+
+    for (int i = 0; i < 2; ++i) {
+        PseudoZDD* zdd = ConstructForTest(line_array[i]);
+        zdd->ReduceAsZDD();
+
+        string hdd_filename = MakeTmpFileNameForTest();
+        OptionParser* parser = new OptionParser;
+        parser->ParseCommandLine(line_array[i]);
+        parser->PrepareGraph();
+        parser->MakeState();
+        PseudoZDD* hdd_zdd = FrontierAlgorithm::Construct(parser->state, hdd_filename, false);
+        hdd_zdd->ReduceAsZDD();
+        assert(hdd_zdd->GetNumberOfNodes() == zdd->GetNumberOfNodes());
+        assert(hdd_zdd->ComputeNumberOfSolutions<BigInteger>().GetString() == result_array[i]);
+
+        // the reduced file is in the format of OutputZDD
+        std::ifstream ifs((hdd_filename + ".reduced").c_str());
+        assert(ifs);
+        PseudoZDD* imported_zdd = new PseudoZDD;
+        imported_zdd->ImportZDD(ifs, false);
+        ifs.close();
+        assert(imported_zdd->GetNumberOfNodes() == zdd->GetNumberOfNodes());
+        assert(imported_zdd->ComputeNumberOfSolutions<BigInteger>().GetString() == result_array[i]);
+
+        unlink(hdd_filename.c_str());
+        unlink((hdd_filename + ".reduced").c_str());
+        delete imported_zdd;
+        delete hdd_zdd;
+        delete parser;
+        delete zdd;
+    }
+}
+
+// The same numbers as --dist size and --restrict 12
+void TestSubsetting()
+{
+    // the family of all 8-edge subsets of grid5x5
+    PseudoZDD* zdd = ConstructForTest("-t combination --elimit 8 --input testdata/grid5x5.txt");
+    zdd->ReduceAsZDD();
+    PseudoZDD* subsetting_dd = ReimportZDDForTest(zdd);
+    assert(CountWithSubsettingForTest("-t stpath --input testdata/grid5x5.txt", subsetting_dd)
+           == "70");
+    delete subsetting_dd;
+    delete zdd;
+
+    // the family of all edge subsets of grid3x3 including the last edge
+    zdd = ConstructForTest("-t combination --elimit [0,12] --input testdata/grid3x3.txt");
+    PseudoZDD* onset_zdd = zdd->Onset(11);
+    subsetting_dd = ReimportZDDForTest(onset_zdd);
+    assert(CountWithSubsettingForTest("-t stpath --input testdata/grid3x3.txt", subsetting_dd)
+           == "6");
+    delete subsetting_dd;
+    delete onset_zdd;
+    delete zdd;
+}
+
+// Combine the s-t paths on grid3x3 (12 paths) with the 4-edge subsets (495 subsets).
+// The numbers are checked by brute force over the outputs of --enum.
+void TestApply()
+{
+    PseudoZDD* zdd1 = ConstructForTest("-t stpath --input testdata/grid3x3.txt");
+    PseudoZDD* zdd2 = ConstructForTest("-t combination --elimit 4 --input testdata/grid3x3.txt");
+
+    ZDDApply apply;
+    intx f = apply.Import(*zdd1);
+    intx g = apply.Import(*zdd2);
+
+    int op_array[] = {ZDDApply::UNION, ZDDApply::INTERSECTION, ZDDApply::DIFFERENCE,
+                      ZDDApply::JOIN, ZDDApply::DISJOINT_PRODUCT};
+    string result_array[] = {"501", "6", "6", "1015", "367"};
+    for (int i = 0; i < 5; ++i) {
+        PseudoZDD* zdd = apply.Export(apply.Apply(op_array[i], f, g));
+        assert(zdd->ComputeNumberOfSolutions<BigInteger>().GetString() == result_array[i]);
+        delete zdd;
+    }
+
+    delete zdd2;
+    delete zdd1;
+}
+
+// Judge takes 0-based levels while samples consist of 1-based edge numbers.
+bool JudgeSampleForTest(PseudoZDD* zdd, std::vector<int> vec)
+{
+    for (frontier_lib::uint i = 0; i < vec.size(); ++i) {
+        --vec[i];
+    }
+    return zdd->Judge(vec);
+}
+
+// Sample the s-t paths on grid3x3 (12 paths) and all the edge subsets of grid8x8 (2^112 subsets,
+// which overflow uintx).
+void TestSampling()
+{
+    PseudoZDD* zdd = ConstructForTest("-t stpath --input testdata/grid3x3.txt");
+    zdd->ReduceAsZDD();
+
+    // uintx and BigInteger draw the same random numbers from the same seed
+    UniformSampler<uintx> sampler(zdd->GetNodeArray(), zdd->GetLevelFirstArray());
+    UniformSampler<BigInteger> big_sampler(zdd->GetNodeArray(), zdd->GetLevelFirstArray());
+    assert(!sampler.IsOverflow());
+    Random64 random(1), big_random(1);
+    std::map<std::vector<int>, int> count_map;
+    for (int i = 0; i < 12000; ++i) {
+        std::vector<int> vec, big_vec;
+        assert(sampler.Sample(&random, &vec));
+        assert(big_sampler.Sample(&big_random, &big_vec));
+        assert(vec == big_vec);
+        assert(JudgeSampleForTest(zdd, vec));
+        ++count_map[vec];
+    }
+    assert(count_map.size() == 12);
+    for (std::map<std::vector<int>, int>::iterator itor = count_map.begin();
+         itor != count_map.end(); ++itor) {
+        assert(800 <= itor->second && itor->second <= 1200);
+    }
+
+    // the same seed gives the same output
+    string output_array[2];
+    for (int k = 0; k < 2; ++k) {
+        FILE* fp = tmpfile();
+        assert(fp != NULL);
+        zdd->OutputSamplingSolutions(fp, 5000, 12345);
+        output_array[k] = ReadTmpFileForTest(fp);
+    }
+    assert(output_array[0] == output_array[1]);
+    assert(std::count(output_array[0].begin(), output_array[0].end(), '\n') == 5000);
+    delete zdd;
+
+    zdd = ConstructForTest("-t combination --elimit [0,112] --input testdata/grid8x8.txt");
+    UniformSampler<uintx> overflow_sampler(zdd->GetNodeArray(), zdd->GetLevelFirstArray());
+    assert(overflow_sampler.IsOverflow());
+    UniformSampler<BigInteger> large_sampler(zdd->GetNodeArray(), zdd->GetLevelFirstArray());
+    int total = 0;
+    for (int i = 0; i < 1000; ++i) {
+        std::vector<int> vec;
+        assert(large_sampler.Sample(&random, &vec));
+        assert(JudgeSampleForTest(zdd, vec));
+        total += static_cast<int>(vec.size());
+    }
+    assert(50000 <= total && total <= 62000); // 56 edges on average
+    delete zdd;
+}
+
+// Sample the s-t paths on grid3x3 with probability proportional to 2^(-the length).
+// The partition function is compared with the one computed from the distribution by size.
+void TestBoltzmannSampling()
+{
+    PseudoZDD* zdd = ConstructForTest("-t stpath --input testdata/grid3x3.txt");
+    zdd->ReduceAsZDD();
+
+    std::vector<int> weight_array(12, 1);
+    std::vector<BigInteger> coef_array;
+    zdd->ComputeGeneratingFunction(weight_array, &coef_array);
+    double z = 0.0;
+    for (frontier_lib::uint k = 0; k < coef_array.size(); ++k) {
+        z += static_cast<double>(coef_array[k]) * pow(0.5, static_cast<double>(k));
+    }
+
+    std::vector<double> log_weight_array(12, -log(2.0));
+    BoltzmannSampler sampler(zdd->GetNodeArray(), zdd->GetLevelFirstArray(), log_weight_array);
+    assert(fabs(sampler.GetLogPartitionFunction() - log(z)) < 1e-9);
+    assert(fabs(zdd->ComputeLogPartitionFunction(log_weight_array) - log(z)) < 1e-9);
+
+    std::vector<int> size_count_array(coef_array.size());
+    Random64 random(1);
+    for (int i = 0; i < 20000; ++i) {
+        std::vector<int> vec;
+        assert(sampler.Sample(&random, &vec));
+        assert(JudgeSampleForTest(zdd, vec));
+        ++size_count_array[vec.size()];
+    }
+    for (frontier_lib::uint k = 0; k < coef_array.size(); ++k) {
+        double expected = static_cast<double>(coef_array[k]) * pow(0.5, static_cast<double>(k)) / z;
+        assert(fabs(size_count_array[k] / 20000.0 - expected) < 0.02);
+    }
+    delete zdd;
+}
+
+std::vector<std::vector<int> > enumerated_solution_array_for_test;
+
+void CollectSolutionForTest(const std::vector<int>& vec)
+{
+    enumerated_solution_array_for_test.push_back(vec);
+}
+
+// Store all the solutions of zdd (as 1-based edge numbers) in (*solution_array)
+void EnumerateForTest(PseudoZDD* zdd, std::vector<std::vector<int> >* solution_array)
+{
+    enumerated_solution_array_for_test.clear();
+    zdd->Enumerate(std::vector<bool>(zdd->GetMaxLevel(), true), CollectSolutionForTest);
+    solution_array->swap(enumerated_solution_array_for_test);
+}
+
+intx SumWeightsForTest(const std::vector<int>& vec, const std::vector<intx>& weight_array)
+{
+    intx sum = 0;
+    for (frontier_lib::uint j = 0; j < vec.size(); ++j) {
+        sum += weight_array[vec[j] - 1];
+    }
+    return sum;
+}
+
+// Enumerate the s-t paths on grid3x3 in the order of the weight, and compare them with
+// the weights of all the paths sorted by brute force.
+void TestOptimal()
+{
+    PseudoZDD* zdd = ConstructForTest("-t stpath --input testdata/grid3x3.txt");
+    zdd->ReduceAsZDD();
+
+    std::vector<intx> weight_array(12);
+    for (int i = 0; i < 12; ++i) {
+        weight_array[i] = (i * 7) % 5 - 2;
+    }
+
+    std::vector<std::vector<int> > solution_array;
+    EnumerateForTest(zdd, &solution_array);
+    std::vector<intx> all_weight_array;
+    for (frontier_lib::uint i = 0; i < solution_array.size(); ++i) {
+        all_weight_array.push_back(SumWeightsForTest(solution_array[i], weight_array));
+    }
+    assert(all_weight_array.size() == 12);
+    std::sort(all_weight_array.begin(), all_weight_array.end());
+
+    for (int is_max = 0; is_max < 2; ++is_max) {
+        OptimalCalculator calculator(zdd->GetNodeArray(), zdd->GetLevelFirstArray(),
+                                     weight_array, is_max != 0);
+        std::set<std::vector<int> > solution_set;
+        for (int rank = 0; rank < 12; ++rank) {
+            intx weight;
+            std::vector<int> vec;
+            assert(calculator.GetSolution(rank, &weight, &vec));
+            assert(JudgeSampleForTest(zdd, vec));
+            assert(SumWeightsForTest(vec, weight_array) == weight);
+            assert(weight == all_weight_array[is_max != 0 ? 11 - rank : rank]);
+            solution_set.insert(vec);
+        }
+        assert(solution_set.size() == 12);
+        intx weight;
+        std::vector<int> vec;
+        assert(!calculator.GetSolution(12, &weight, &vec));
+    }
+    delete zdd;
+
+    // the first 100000 edge subsets of grid5x5 (40 edges) by the number of edges:
+    // C(40, 0) + ... + C(40, 3) = 10701 subsets with at most 3 edges and 89299 with 4 edges
+    zdd = ConstructForTest("-t combination --elimit [0,40] --input testdata/grid5x5.txt");
+    OptimalCalculator calculator(zdd->GetNodeArray(), zdd->GetLevelFirstArray(),
+                                 std::vector<intx>(40, 1), false);
+    std::vector<int> count_array(5);
+    for (int rank = 0; rank < 100000; ++rank) {
+        intx weight;
+        std::vector<int> vec;
+        assert(calculator.GetSolution(rank, &weight, &vec));
+        assert(weight == static_cast<intx>(vec.size()));
+        ++count_array[weight];
+    }
+    assert(count_array[0] + count_array[1] + count_array[2] + count_array[3] == 10701);
+    assert(count_array[4] == 89299);
+    delete zdd;
+}
+
+// Compute the Pareto optimal s-t paths on grid3x3 for two weights, and compare them with
+// the ones computed by brute force over all the paths.
+void TestPareto()
+{
+    PseudoZDD* zdd = ConstructForTest("-t stpath --input testdata/grid3x3.txt");
+    zdd->ReduceAsZDD();
+
+    std::vector<intx> weight1_array(12), weight2_array(12);
+    for (int i = 0; i < 12; ++i) {
+        weight1_array[i] = (i * 7) % 5 + 1;
+        weight2_array[i] = 6 - weight1_array[i]; // trade-off between the two weights
+    }
+
+    std::vector<std::vector<int> > solution_array;
+    EnumerateForTest(zdd, &solution_array);
+    std::vector<std::pair<intx, intx> > all_value_array;
+    for (frontier_lib::uint i = 0; i < solution_array.size(); ++i) {
+        all_value_array.push_back(std::make_pair(SumWeightsForTest(solution_array[i], weight1_array),
+                                                 SumWeightsForTest(solution_array[i], weight2_array)));
+    }
+    std::set<std::pair<intx, intx> > pareto_set;
+    for (frontier_lib::uint i = 0; i < all_value_array.size(); ++i) {
+        bool is_dominated = false;
+        for (frontier_lib::uint j = 0; j < all_value_array.size(); ++j) {
+            if (all_value_array[j] != all_value_array[i]
+                && all_value_array[j].first <= all_value_array[i].first
+                && all_value_array[j].second <= all_value_array[i].second) {
+                is_dominated = true;
+            }
+        }
+        if (!is_dominated) {
+            pareto_set.insert(all_value_array[i]);
+        }
+    }
+
+    ParetoCalculator calculator(zdd->GetNodeArray(), zdd->GetLevelFirstArray(),
+                                weight1_array, weight2_array);
+    assert(pareto_set.size() > 1);
+    assert(calculator.GetNumberOfSolutions() == static_cast<intx>(pareto_set.size()));
+    std::set<std::pair<intx, intx> >::iterator itor = pareto_set.begin();
+    for (intx i = 0; i < calculator.GetNumberOfSolutions(); ++i, ++itor) {
+        intx value1, value2;
+        std::vector<int> vec;
+        calculator.GetSolution(i, &value1, &value2, &vec);
+        assert(JudgeSampleForTest(zdd, vec));
+        assert(std::make_pair(value1, value2) == *itor);
+        assert(SumWeightsForTest(vec, weight1_array) == value1);
+        assert(SumWeightsForTest(vec, weight2_array) == value2);
+    }
+    delete zdd;
+}
+
 int main()
 {
     //mtrace(); // for debug
@@ -289,16 +946,28 @@ int main()
     //MakeTestPartitionOnGrid(&test_list);
     MakeTestSTPathOnRandom(&test_list);
     MakeTestSTPathDistOnRandom(&test_list);
+    MakeTestSTPathDistOnGrid(&test_list);
     MakeTestMTPathOnRandom(&test_list);
+    MakeTestLookahead(&test_list);
     MakeTestPathMatchingOnRandom(&test_list);
     MakeTestKcutOnRandom(&test_list);
     MakeTestRForestOnRandom(&test_list);
     MakeTestRcutOnRandom(&test_list);
+    MakeTestWeightLowerBound(&test_list);
     //MakeTestPartition2OnRandom(&test_list);
     //MakeTestPartition3OnRandom(&test_list);
     //MakeTestVertexWeightOnRandom(&test_list);
     //MakeTestVertexWeightBoundOnRandom(&test_list);
     MakeTestSetptpkc(&test_list);
+    MakeTestReduceOnTheFly(&test_list);
+    string hdd_filename = MakeTmpFileNameForTest();
+    MakeTestHdd(&test_list, hdd_filename);
+    MakeTestEvalCount(&test_list);
+    MakeTestModular(&test_list);
+    MakeTestAdaptive(&test_list);
+    MakeTestDistribution(&test_list);
+    MakeTestMarginal(&test_list);
+    MakeTestRestrict(&test_list);
 
     for (frontier_lib::uint i = 0; i < test_list.size(); ++i) {
         OptionParser* parser = new OptionParser;
@@ -308,8 +977,67 @@ int main()
         parser->PrepareGraph();
         parser->MakeState();
 
-        PseudoZDD* zdd = FrontierAlgorithm::Construct(parser->state);
+        if (parser->eval_kind == OptionParser::EVAL_COUNT) {
+            assert(FrontierAlgorithm::Evaluate(parser->state,
+                                               CountingSemiring<BigInteger>()).GetString()
+                   == test_list[i].second);
+            delete parser;
+            continue;
+        }
+
+        PseudoZDD* zdd = FrontierAlgorithm::Construct(parser->state, parser->hdd_filename,
+                                                      parser->is_reduce_on_the_fly);
+
+        if (parser->dist_kind == OptionParser::DIST_SIZE) {
+            std::vector<int> weight_array(parser->igraph->GetNumberOfEdges(), 1);
+            std::vector<BigInteger> coef_array;
+            zdd->ComputeGeneratingFunction(weight_array, &coef_array);
+            std::ostringstream oss;
+            for (frontier_lib::uint k = 0; k < coef_array.size(); ++k) {
+                if (coef_array[k].GetString() != "0") {
+                    oss << (oss.str().empty() ? "" : " ") << k << ":" << coef_array[k];
+                }
+            }
+            assert(oss.str() == test_list[i].second);
+            delete zdd;
+            delete parser;
+            continue;
+        }
 
+        if (parser->is_marginal) {
+            if (parser->is_reduce) {
+                zdd->ReduceAsZDD();
+            }
+            std::vector<BigInteger> marginal_array;
+            zdd->ComputeMarginals(&marginal_array);
+            std::ostringstream oss;
+            for (int k = 0; k < parser->igraph->GetNumberOfEdges(); ++k) {
+                oss << (k > 0 ? " " : "") << marginal_array[k];
+            }
+            assert(oss.str() == test_list[i].second);
+            delete zdd;
+            delete parser;
+            continue;
+        }
+
+        if (!parser->restrict_list.empty()) {
+            if (parser->is_reduce) {
+                zdd->ReduceAsZDD();
+            }
+            std::vector<int> value_array;
+            parser->MakeRestrictArray(&value_array);
+            assert(zdd->ComputeNumberOfRestrictedSolutions<BigInteger>(value_array).GetString()
+                   == test_list[i].second);
+            PseudoZDD* restricted_zdd = zdd->Restrict(value_array);
+            delete zdd;
+            zdd = restricted_zdd;
+        }
+
+        if (parser->precision_kind == OptionParser::MODULAR) {
+            assert(zdd->ComputeNumberOfSolutionsByCRT().GetString() == test_list[i].second);
+        } else if (parser->precision_kind == OptionParser::ADAPTIVE) {
+            assert(zdd->ComputeNumberOfSolutionsAdaptively().GetString() == test_list[i].second);
+        }
         assert(zdd->ComputeNumberOfSolutions<BigInteger>().GetString() == test_list[i].second);
 
         //parser.Output(zdd);
@@ -317,6 +1045,17 @@ int main()
         delete zdd;
         delete parser;
     }
+    unlink(hdd_filename.c_str());
+
+    TestBigIntegerString();
+    TestReliability();
+    TestApply();
+    TestHddReduce();
+    TestSubsetting();
+    TestSampling();
+    TestBoltzmannSampling();
+    TestOptimal();
+    TestPareto();
 
     //muntrace(); // for debug
 
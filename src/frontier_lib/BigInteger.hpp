@@ -26,6 +26,8 @@
 #include <string>
 #include <climits>
 #include <sstream>
+#include <iomanip>
+#include <algorithm>
 
 #include "Global.hpp"
 
@@ -33,7 +35,7 @@ namespace frontier_lib {
 
 //*************************************************************************************************
 // BigDecimal: 任意桁の10進数を表すクラス
-// BigInteger クラスの数を10進数の文字列に変換するために用いられる
+// 128 ビット整数が使えない環境で、BigInteger クラスの数を10進数の文字列に変換するために用いられる
 class BigDecimal {
 private:
     std::vector<int> place_list_;
@@ -125,6 +127,90 @@ public:
        return *this;
     }
 
+    BigInteger& operator*=(const BigInteger& integer)
+    {
+        std::vector<uint64> result(place_list_.size() + integer.place_list_.size());
+        for (uint i = 0; i < place_list_.size(); ++i) {
+            uint64 c = 0;
+            for (uint j = 0; j < integer.place_list_.size(); ++j) {
+                uint64 hi, lo;
+                Multiply64(place_list_[i], integer.place_list_[j], &hi, &lo);
+                lo += c;
+                if (lo < c) {
+                    ++hi;
+                }
+                result[i + j] += lo;
+                if (result[i + j] < lo) {
+                    ++hi;
+                }
+                c = hi;
+            }
+            result[i + integer.place_list_.size()] = c;
+        }
+        while (result.size() > 1 && result.back() == 0) {
+            result.pop_back();
+        }
+        place_list_.swap(result);
+        return *this;
+    }
+
+    bool operator==(const BigInteger& integer) const
+    {
+        uint n = static_cast<uint>(std::max(place_list_.size(), integer.place_list_.size()));
+        for (uint i = 0; i < n; ++i) {
+            uint64 q1 = (i < place_list_.size() ? place_list_[i] : 0);
+            uint64 q2 = (i < integer.place_list_.size() ? integer.place_list_[i] : 0);
+            if (q1 != q2) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool operator!=(const BigInteger& integer) const
+    {
+        return !(*this == integer);
+    }
+
+    bool operator<(const BigInteger& integer) const
+    {
+        uint n = static_cast<uint>(std::max(place_list_.size(), integer.place_list_.size()));
+        for (int i = static_cast<int>(n) - 1; i >= 0; --i) {
+            uint64 q1 = (i < static_cast<int>(place_list_.size()) ? place_list_[i] : 0);
+            uint64 q2 = (i < static_cast<int>(integer.place_list_.size()) ? integer.place_list_[i] : 0);
+            if (q1 != q2) {
+                return q1 < q2;
+            }
+        }
+        return false;
+    }
+
+    // *this >= integer でなければならない
+    BigInteger& operator-=(const BigInteger& integer)
+    {
+        uint64 borrow = 0;
+        for (uint i = 0; i < place_list_.size(); ++i) {
+            uint64 q1 = place_list_[i];
+            uint64 q2 = (i < integer.place_list_.size() ? integer.place_list_[i] : 0);
+            place_list_[i] = q1 - q2 - borrow;
+            borrow = (q1 < q2 || (q1 == q2 && borrow > 0) ? 1 : 0);
+        }
+        while (place_list_.size() > 1 && place_list_.back() == 0) {
+            place_list_.pop_back();
+        }
+        return *this;
+    }
+
+    int GetNumberOfPlaces() const
+    {
+        return static_cast<int>(place_list_.size());
+    }
+
+    uint64 GetPlace(int place) const
+    {
+        return place_list_[place];
+    }
+
     operator double() const
     {
         double d = 0.0;
@@ -135,6 +221,39 @@ public:
         return d;
     }
 
+    // *this = *this * multiplier + addend
+    BigInteger& MultiplyAndAdd(uint64 multiplier, uint64 addend)
+    {
+        uint64 c = addend;
+        for (uint i = 0; i < place_list_.size(); ++i) {
+            uint64 hi, lo;
+            Multiply64(place_list_[i], multiplier, &hi, &lo);
+            lo += c;
+            if (lo < c) {
+                ++hi;
+            }
+            place_list_[i] = lo;
+            c = hi;
+        }
+        if (c > 0) {
+            place_list_.push_back(c);
+        }
+        return *this;
+    }
+
+    // a * b = (*hi) * 2^64 + (*lo)
+    static void Multiply64(uint64 a, uint64 b, uint64* hi, uint64* lo)
+    {
+        const uint64 mask = 0xffffffffull;
+        uint64 p00 = (a & mask) * (b & mask);
+        uint64 p01 = (a & mask) * (b >> 32);
+        uint64 p10 = (a >> 32) * (b & mask);
+        uint64 p11 = (a >> 32) * (b >> 32);
+        uint64 mid = (p00 >> 32) + (p01 & mask) + (p10 & mask);
+        *lo = (mid << 32) | (p00 & mask);
+        *hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+    }
+
     void Set(int place, uint64 value)
     {
         if (place >= static_cast<int>(place_list_.size())) {
@@ -143,6 +262,34 @@ public:
         place_list_[place] = value;
     }
 
+#ifdef __SIZEOF_INT128__
+    // 10^19 進数に分割統治で変換してから文字列にする。
+    // 上位と下位の limb をそれぞれ変換し、上位に 2^(64 * 2^k) の 10^19 進表現を掛けて足す。
+    // 乗算には Karatsuba 法を用いるので、桁数について 2 乗より小さい計算量で変換できる。
+    std::string GetString() const
+    {
+        int n = static_cast<int>(place_list_.size());
+        while (n > 1 && place_list_[n - 1] == 0) {
+            --n;
+        }
+        std::vector<std::vector<uint64> > power_array; // power_array[k]: 2^(64 * 2^k) の 10^19 進表現
+        power_array.push_back(ConvertLimb(0, 1));
+        while ((1 << power_array.size()) < n) {
+            std::vector<uint64> square;
+            Multiply(power_array.back(), power_array.back(), &square);
+            power_array.push_back(square);
+        }
+        std::vector<uint64> dec;
+        ConvertToDecimal(0, n, power_array, &dec);
+
+        std::ostringstream oss;
+        oss << dec.back();
+        for (int i = static_cast<int>(dec.size()) - 2; i >= 0; --i) {
+            oss << std::setw(19) << std::setfill('0') << dec[i];
+        }
+        return oss.str();
+    }
+#else
     std::string GetString() const
     {
         BigDecimal d;
@@ -157,10 +304,151 @@ public:
         }
         return d.GetString();
     }
+#endif
+
+private:
+#ifdef __SIZEOF_INT128__
+    // 以下、10^19 進数は下位の桁から順に uint64 の配列に格納し、最上位の桁以外は 0 でない
+    static const uint64 DECIMAL_BASE = 10000000000000000000ull; // 10^19
+    enum {KARATSUBA_THRESHOLD = 32};
+
+    // hi * 2^64 + lo の 10^19 進表現（hi < 2^64 を仮定。3 桁以下）
+    static std::vector<uint64> ConvertLimb(uint64 lo, uint64 hi)
+    {
+        unsigned __int128 v = (static_cast<unsigned __int128>(hi) << 64) | lo;
+        std::vector<uint64> dec;
+        do {
+            dec.push_back(static_cast<uint64>(v % DECIMAL_BASE));
+            v /= DECIMAL_BASE;
+        } while (v > 0);
+        return dec;
+    }
+
+    // place_list_[first, last) の表す数を 10^19 進数に変換して *dec に格納する
+    void ConvertToDecimal(int first, int last,
+                          const std::vector<std::vector<uint64> >& power_array,
+                          std::vector<uint64>* dec) const
+    {
+        if (last - first == 1) {
+            *dec = ConvertLimb(place_list_[first], 0);
+            return;
+        }
+        int k = 0;
+        while ((2 << k) < last - first) {
+            ++k;
+        }
+        int mid = first + (1 << k);
+        std::vector<uint64> high;
+        ConvertToDecimal(mid, last, power_array, &high);
+        ConvertToDecimal(first, mid, power_array, dec);
+        std::vector<uint64> product;
+        Multiply(high, power_array[k], &product);
+        AddDecimal(product, dec);
+        Normalize(dec);
+    }
+
+    // *a += b
+    static void AddDecimal(const std::vector<uint64>& b, std::vector<uint64>* a, size_t offset = 0)
+    {
+        if (a->size() < b.size() + offset) {
+            a->resize(b.size() + offset, 0);
+        }
+        uint64 c = 0;
+        size_t i = offset;
+        for (; i < b.size() + offset || (c > 0 && i < a->size()); ++i) {
+            // 2 つの桁の和は 2^64 を超え得るので、10^19 との差で比較する
+            uint64 x = (*a)[i] + c;
+            uint64 y = (i < b.size() + offset ? b[i - offset] : 0);
+            if (x >= DECIMAL_BASE - y) {
+                (*a)[i] = x - (DECIMAL_BASE - y);
+                c = 1;
+            } else {
+                (*a)[i] = x + y;
+                c = 0;
+            }
+        }
+        if (c > 0) {
+            a->push_back(c);
+        }
+    }
 
+    // *a -= b（*a >= b を仮定）
+    static void SubtractDecimal(const std::vector<uint64>& b, std::vector<uint64>* a)
+    {
+        uint64 c = 0;
+        for (size_t i = 0; i < b.size() || c > 0; ++i) {
+            uint64 d = (i < b.size() ? b[i] : 0) + c;
+            if ((*a)[i] >= d) {
+                (*a)[i] -= d;
+                c = 0;
+            } else {
+                (*a)[i] += DECIMAL_BASE - d;
+                c = 1;
+            }
+        }
+        Normalize(a);
+    }
+
+    static void Normalize(std::vector<uint64>* a)
+    {
+        while (a->size() > 1 && a->back() == 0) {
+            a->pop_back();
+        }
+    }
+
+    // *result = a * b
+    static void Multiply(const std::vector<uint64>& a, const std::vector<uint64>& b,
+                         std::vector<uint64>* result)
+    {
+        if (a.size() < KARATSUBA_THRESHOLD || b.size() < KARATSUBA_THRESHOLD) {
+            result->assign(a.size() + b.size(), 0);
+            for (size_t i = 0; i < a.size(); ++i) {
+                uint64 c = 0;
+                for (size_t j = 0; j < b.size(); ++j) {
+                    unsigned __int128 t = static_cast<unsigned __int128>(a[i]) * b[j]
+                        + (*result)[i + j] + c;
+                    (*result)[i + j] = static_cast<uint64>(t % DECIMAL_BASE);
+                    c = static_cast<uint64>(t / DECIMAL_BASE);
+                }
+                (*result)[i + b.size()] = c;
+            }
+            Normalize(result);
+            return;
+        }
+        // a = a1 * B^h + a0, b = b1 * B^h + b0 とすると、
+        // a * b = z2 * B^(2h) + (z1 - z2 - z0) * B^h + z0
+        // (z2 = a1 * b1, z0 = a0 * b0, z1 = (a1 + a0) * (b1 + b0))
+        size_t h = std::max(a.size(), b.size()) / 2;
+        std::vector<uint64> a0(a.begin(), a.begin() + std::min(h, a.size()));
+        std::vector<uint64> a1(a.begin() + std::min(h, a.size()), a.end());
+        std::vector<uint64> b0(b.begin(), b.begin() + std::min(h, b.size()));
+        std::vector<uint64> b1(b.begin() + std::min(h, b.size()), b.end());
+        Normalize(&a0);
+        Normalize(&b0);
+        if (a1.empty()) {
+            a1.push_back(0);
+        }
+        if (b1.empty()) {
+            b1.push_back(0);
+        }
+        std::vector<uint64> z0, z1, z2;
+        Multiply(a0, b0, &z0);
+        Multiply(a1, b1, &z2);
+        AddDecimal(a0, &a1);
+        AddDecimal(b0, &b1);
+        Multiply(a1, b1, &z1);
+        SubtractDecimal(z0, &z1);
+        SubtractDecimal(z2, &z1);
+
+        *result = z0;
+        AddDecimal(z1, result, h);
+        AddDecimal(z2, result, 2 * h);
+        Normalize(result);
+    }
+#endif
 };
 
-inline std::ostream& operator<<(std::ostream& ost, BigInteger& integer)
+inline std::ostream& operator<<(std::ostream& ost, const BigInteger& integer)
 {
     ost << integer.GetString();
     return ost;
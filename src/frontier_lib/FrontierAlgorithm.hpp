@@ -36,6 +36,7 @@
 #include "Mate.hpp"
 #include "PseudoZDD.hpp"
 #include "HashTable.hpp"
+#include "Semiring.hpp"
 
 namespace frontier_lib {
 
@@ -48,7 +49,10 @@ private:
     static const intx INITIAL_HASH_SIZE_ = (1ll << 26);
 
 public:
-    static PseudoZDD* Construct(State* state, std::string filename = "")
+    // is_reduce_on_the_fly が true の場合、構築中に処理済みのレベルを随時既約化して詰め、
+    // 構築後に全体を既約化する（-r を指定した場合と同じ ZDD が得られる）
+    static PseudoZDD* Construct(State* state, std::string filename = "",
+                                bool is_reduce_on_the_fly = false)
     {
         PseudoZDD* zdd = new PseudoZDD();
         if (!filename.empty()) {
@@ -122,6 +126,9 @@ public:
                 }
             }
             global_hash_table.Flush();
+            if (is_reduce_on_the_fly) {
+                zdd->ReduceFinishedLevels();
+            }
 #ifndef DEBUG
             state->PrintNodeNum(zdd->GetNumberOfNodes());
 #endif
@@ -130,8 +137,85 @@ public:
         delete mate;
         zdd->SetHashTable(NULL);
         zdd->HddTerminate();
+        if (is_reduce_on_the_fly) { // 最後に詰めた後のレベルも既約化する
+            zdd->ReduceAsZDD();
+        }
         return zdd;
     }
+
+    // ZDD を構築せずに、半環 semiring の値を各ノードに持たせてトップダウンに評価する。
+    // 等価なノードに合流するときは値を合わせ、1終端に到達した値の和を返す。
+    // 保持するのは処理中のレベルと次のレベルのノードの値のみである。
+    // semiring に与えるクラスは Semiring.hpp を参照。
+    template <typename S>
+    static typename S::ValueType Evaluate(State* state, const S& semiring)
+    {
+        typedef typename S::ValueType T;
+
+        PseudoZDD* zdd = new PseudoZDD();
+        zdd->SetDiscardNodes();
+        ZDDNode* root_node = zdd->CreateRootNode(); // 根ノードの作成
+
+        HashTable global_hash_table(INITIAL_HASH_SIZE_); // ノード検索用ハッシュ
+        zdd->SetHashTable(&global_hash_table);
+
+        Mate* mate = state->Initialize(root_node);
+
+        std::vector<T> value_array(1, semiring.One()); // 現在のレベルのノードの値
+        std::vector<T> next_value_array; // 次のレベルのノードの値
+        T result = semiring.Zero(); // 1終端に到達した値
+
+        for (int edge = 1; edge <= state->GetNumberOfEdges(); ++edge) {
+            state->StartNextEdge();
+            zdd->SetLevelStart();
+            mate->SetOffset();
+            next_value_array.clear();
+
+            for (intx i = 0; i < zdd->GetCurrentLevelSize(); ++i) {
+                ZDDNode* node = zdd->GetCurrentLevelNode(i);
+
+                for (int child_num = 0; child_num < state->GetNumberOfChildren(); ++child_num) {
+
+                    state->UnpackMate(node, mate, child_num);
+
+                    ZDDNode* child_node = state->MakeNewNode(node, mate, child_num, zdd);
+
+                    if (child_node == zdd->ZeroTerminal) {
+                        continue;
+                    }
+                    const T& value = semiring.Extend(value_array[i],
+                                                     state->GetCurrentEdgeNumber(), child_num);
+                    if (child_node == zdd->OneTerminal) {
+                        semiring.Add(&result, semiring.ExtendToEnd(value,
+                                                                   state->GetCurrentEdgeNumber()));
+                        continue;
+                    }
+
+                    state->PackMate(child_node, mate);
+
+                    intx index = zdd->FindNodeFromNextLevel(*child_node, state, mate);
+                    if (index >= 0) { // 等価なノードが存在する
+                        zdd->DestructNode(child_node, state, mate);
+                        semiring.Add(&next_value_array[index], value);
+                    } else { // 等価なノードが存在しない
+                        zdd->AddNodeToNextLevel(child_node, state, mate);
+                        if (edge == state->GetNumberOfEdges()) { // for multi-terminal
+                            state->OutputMultiterminal(mate);
+                        }
+                        next_value_array.push_back(value);
+                    }
+                }
+            }
+            global_hash_table.Flush();
+            value_array.swap(next_value_array);
+#ifndef DEBUG
+            state->PrintNodeNum(zdd->GetNumberOfNodes());
+#endif
+        }
+        delete mate;
+        delete zdd;
+        return result;
+    }
 };
 
 
@@ -47,6 +47,8 @@ private:
     std::vector<int> leaving_frontier_array_;
 
     std::vector<int> both_frontier_array_;
+    // フロンティアから抜ける頂点の both_frontier_array_ における位置の配列（昇順）
+    std::vector<int> leaving_position_array_;
 
     const Graph* const graph_;
     const HyperGraph* const hgraph_;
@@ -129,6 +131,15 @@ public:
                                            next_frontier_array_.end());
             }
         }
+
+        leaving_position_array_.clear();
+        for (uint i = 0; i < leaving_frontier_array_.size(); ++i) {
+            leaving_position_array_.push_back(static_cast<int>(std::find(both_frontier_array_.begin(),
+                                                                         both_frontier_array_.end(),
+                                                                         leaving_frontier_array_[i])
+                                                               - both_frontier_array_.begin()));
+        }
+        std::sort(leaving_position_array_.begin(), leaving_position_array_.end());
     }
 
     int GetPreviousFrontierSize() const
@@ -181,6 +192,12 @@ public:
         return both_frontier_array_[index];
     }
 
+    // フロンティアから抜ける頂点の both frontier における位置のうち、index 番目に小さいもの
+    int GetLeavingFrontierPosition(int index) const
+    {
+        return leaving_position_array_[index];
+    }
+
     bool FindInEnteringFrontier(int element)
     {
         return std::find(entering_frontier_array_.begin(),
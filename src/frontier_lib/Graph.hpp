@@ -23,6 +23,8 @@
 
 #include <vector>
 #include <list>
+#include <queue>
+#include <functional>
 #include <algorithm>
 #include <iostream>
 #include <sstream>
@@ -57,6 +59,9 @@ public:
 //*************************************************************************************************
 // Graph: グラフを表すクラス
 class Graph : public GraphInterface {
+public:
+    enum {INFINITE_DISTANCE = 99999999}; // 到達不能な頂点への距離
+
 private:
     bool is_directed_;
     bool is_simple_;
@@ -179,7 +184,7 @@ public:
         int c;
         bool is_end = false;
 
-        for (int i = 0; i < number_of_vertices_; ++i)
+        for (int i = 0; i < number_of_edges_; ++i)
             {
                 if (is_end) {
                     edge_array_[i].weight = 1;
@@ -407,7 +412,7 @@ public:
                 if (i == j) {
                     ar.push_back(0);
                 } else {
-                    ar.push_back(99999999);
+                    ar.push_back(INFINITE_DISTANCE);
                 }
             }
         }
@@ -431,6 +436,56 @@ public:
         }
     }
 
+    // 頂点 source から各頂点への最短距離を dist_array に格納する（無向グラフとして扱う）。
+    // dist_array のサイズは (頂点数 + 1) になり、到達不能な頂点には INFINITE_DISTANCE が入る。
+    // すべての辺の重みが 1 なら幅優先探索、そうでなければ Dijkstra 法を用いる。
+    // 重みは非負でなければならない。
+    void ComputeShortestDistance(int source, std::vector<int>* dist_array) const
+    {
+        std::vector<int> adj_first_array;
+        std::vector<std::pair<int, int> > adj_array; // (隣接頂点, 重み)
+        bool is_unit_weight = MakeAdjacencyArray(&adj_first_array, &adj_array);
+
+        dist_array->assign(number_of_vertices_ + 1, INFINITE_DISTANCE);
+        (*dist_array)[source] = 0;
+
+        if (is_unit_weight) { // 幅優先探索
+            std::vector<int> queue_array;
+            queue_array.reserve(number_of_vertices_);
+            queue_array.push_back(source);
+            for (size_t pos = 0; pos < queue_array.size(); ++pos) {
+                int v = queue_array[pos];
+                for (int i = adj_first_array[v]; i < adj_first_array[v + 1]; ++i) {
+                    int w = adj_array[i].first;
+                    if ((*dist_array)[w] == INFINITE_DISTANCE) {
+                        (*dist_array)[w] = (*dist_array)[v] + 1;
+                        queue_array.push_back(w);
+                    }
+                }
+            }
+        } else { // Dijkstra 法
+            typedef std::pair<int, int> DistPair; // (距離, 頂点)
+            std::priority_queue<DistPair, std::vector<DistPair>, std::greater<DistPair> > pq;
+            pq.push(std::make_pair(0, source));
+            while (!pq.empty()) {
+                DistPair dp = pq.top();
+                pq.pop();
+                int v = dp.second;
+                if (dp.first > (*dist_array)[v]) { // 既により短い距離で確定済み
+                    continue;
+                }
+                for (int i = adj_first_array[v]; i < adj_first_array[v + 1]; ++i) {
+                    int w = adj_array[i].first;
+                    int d = dp.first + adj_array[i].second;
+                    if (d < (*dist_array)[w]) {
+                        (*dist_array)[w] = d;
+                        pq.push(std::make_pair(d, w));
+                    }
+                }
+            }
+        }
+    }
+
     void PrintDistMatrix() const
     {
         for (int j = 1; j <= number_of_vertices_; ++j) {
@@ -444,12 +499,14 @@ public:
     void RemoveVertices(const std::vector<int>& remove_array,
         const std::vector<int>& new_var_array)
     {
+        std::vector<bool> is_removed_array(number_of_vertices_ + 1, false);
+        for (unsigned int i = 0; i < remove_array.size(); ++i) {
+            is_removed_array[remove_array[i]] = true;
+        }
+
         std::vector<Edge> new_edge_array;
         for (unsigned int i = 0; i < edge_array_.size(); ++i) {
-            if (std::find(remove_array.begin(), remove_array.end(), edge_array_[i].src)
-                == remove_array.end()
-                && std::find(remove_array.begin(), remove_array.end(), edge_array_[i].dest)
-                == remove_array.end()) {
+            if (!is_removed_array[edge_array_[i].src] && !is_removed_array[edge_array_[i].dest]) {
                 new_edge_array.push_back(edge_array_[i]);
             }
         }
@@ -469,6 +526,41 @@ public:
     }
 
 private:
+    // 無向グラフとしての隣接配列を作る。頂点 v の隣接頂点は
+    // adj_array[adj_first_array[v]] ... adj_array[adj_first_array[v + 1] - 1] に格納される。
+    // すべての辺の重みが 1 なら true を返す。
+    bool MakeAdjacencyArray(std::vector<int>* adj_first_array,
+                            std::vector<std::pair<int, int> >* adj_array) const
+    {
+        bool is_unit_weight = true;
+
+        adj_first_array->assign(number_of_vertices_ + 2, 0);
+        for (size_t i = 0; i < edge_array_.size(); ++i) {
+            const Edge& edge = edge_array_[i];
+            if (edge.src != edge.dest) {
+                ++(*adj_first_array)[edge.src + 1];
+                ++(*adj_first_array)[edge.dest + 1];
+            }
+            if (edge.weight != 1) {
+                is_unit_weight = false;
+            }
+        }
+        for (int v = 1; v <= number_of_vertices_ + 1; ++v) {
+            (*adj_first_array)[v] += (*adj_first_array)[v - 1];
+        }
+
+        std::vector<int> pos_array(adj_first_array->begin(), adj_first_array->end() - 1);
+        adj_array->resize(adj_first_array->back());
+        for (size_t i = 0; i < edge_array_.size(); ++i) {
+            const Edge& edge = edge_array_[i];
+            if (edge.src != edge.dest) {
+                (*adj_array)[pos_array[edge.src]++] = std::make_pair(edge.dest, edge.weight);
+                (*adj_array)[pos_array[edge.dest]++] = std::make_pair(edge.src, edge.weight);
+            }
+        }
+        return is_unit_weight;
+    }
+
     void LoadAdjacencyListUndirected(std::istream& ist)
     {
         std::string s;
@@ -140,7 +140,7 @@ public:
         int c;
         bool is_end = false;
     
-        for (int i = 0; i < number_of_vertices_; ++i)
+        for (int i = 0; i < number_of_edges_; ++i)
         {
             if (is_end) {
                 edge_array_[i].weight = 1;
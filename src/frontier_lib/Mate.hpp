@@ -265,6 +265,140 @@ public:
     }
 };
 
+//*************************************************************************************************
+// MateBit: フロンティアの各要素について 1 ビットの情報（被覆済みか否かなど）のみを持つ mate。
+// ビットを 64 ビットのワードに詰めて格納し、更新、比較、ハッシュ値の計算をワード単位で行う。
+// 辺の処理中は、both frontier（previous frontier の後に entering frontier が続く）の
+// i 番目の要素を i 番目のビットに対応させる。PackMate の際にフロンティアから抜ける要素の
+// ビットを取り除くので、格納されるビット列は next frontier の並びに対応する。
+class MateBit : public MateS {
+public:
+    enum {WORD_BITS = 64};
+
+    uint64* bits;
+private:
+    RBuffer<uint64> bits_buffer_;
+    intx b_offset_;
+
+public:
+    MateBit(State* state) : b_offset_(0)
+    {
+        int number_of_words = GetNumberOfWords(state->GetNumberOfVertices() + 1);
+        bits = new uint64[number_of_words];
+        std::fill(bits, bits + number_of_words, 0);
+    }
+
+    virtual ~MateBit()
+    {
+        delete[] bits;
+    }
+
+    // size ビットを格納するのに必要なワード数
+    static int GetNumberOfWords(int size)
+    {
+        return (size + WORD_BITS - 1) / WORD_BITS;
+    }
+
+    bool GetBit(int pos) const
+    {
+        return ((bits[pos / WORD_BITS] >> (pos % WORD_BITS)) & 1) != 0;
+    }
+
+    virtual void SetOffset()
+    {
+        MateS::SetOffset();
+        b_offset_ = bits_buffer_.GetHeadIndex();
+    }
+
+    virtual bool Equals(const ZDDNode& node1, const ZDDNode& node2,
+                const FrontierManager& frontier_manager) const
+    {
+        if (!MateS::Equals(node1, node2, frontier_manager)) {
+            return false;
+        }
+        int number_of_words = GetNumberOfWords(frontier_manager.GetNextFrontierSize());
+        for (int i = 0; i < number_of_words; ++i) {
+            if (bits_buffer_.GetValue(b_offset_ + node1.node_number * number_of_words + i)
+                != bits_buffer_.GetValue(b_offset_ + node2.node_number * number_of_words + i)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    virtual intx GetHashValue(const ZDDNode& node, const FrontierManager& frontier_manager) const
+    {
+        uintx hash_value = MateS::GetHashValue(node, frontier_manager);
+
+        int number_of_words = GetNumberOfWords(frontier_manager.GetNextFrontierSize());
+        for (int i = 0; i < number_of_words; ++i) {
+            uint64 val = bits_buffer_.GetValue(b_offset_ + node.node_number * number_of_words + i);
+            hash_value = hash_value * 3161391051631ll + (val ^ (val >> 29));
+        }
+        return hash_value;
+    }
+
+    virtual void PackMate(ZDDNode* node, const FrontierManager& frontier_manager)
+    {
+        MateS::PackMate(node, frontier_manager);
+
+        int number_of_words = GetNumberOfWords(frontier_manager.GetBothFrontierSize());
+
+        // フロンティアから抜ける要素のビットを、位置の大きいものから順に取り除く
+        for (int i = frontier_manager.GetLeavingFrontierSize() - 1; i >= 0; --i) {
+            RemoveBit(frontier_manager.GetLeavingFrontierPosition(i), number_of_words);
+        }
+
+        number_of_words = GetNumberOfWords(frontier_manager.GetNextFrontierSize());
+        for (int i = 0; i < number_of_words; ++i) {
+            bits_buffer_.WriteAndSeekHead(bits[i]);
+        }
+    }
+
+    virtual void UnpackMate(ZDDNode* node, int child_num, const FrontierManager& frontier_manager)
+    {
+        MateS::UnpackMate(node, child_num, frontier_manager);
+
+        int previous_words = GetNumberOfWords(frontier_manager.GetPreviousFrontierSize());
+        int both_words = GetNumberOfWords(frontier_manager.GetBothFrontierSize());
+
+        // 格納されたワードの上位の余ったビットは 0 なので、
+        // entering frontier の要素のビットは 0 になる
+        for (int i = 0; i < previous_words; ++i) {
+            bits[i] = bits_buffer_.GetValueFromTail(i);
+        }
+        for (int i = previous_words; i < both_words; ++i) {
+            bits[i] = 0;
+        }
+
+        if (child_num == 1) {
+            bits_buffer_.SeekTail(previous_words);
+        }
+    }
+
+    virtual void Revert(const FrontierManager& frontier_manager)
+    {
+        MateS::Revert(frontier_manager);
+
+        bits_buffer_.BackHead(GetNumberOfWords(frontier_manager.GetNextFrontierSize()));
+    }
+
+private:
+    // pos 番目のビットを取り除き、それより上位のビットを 1 つずつ下位へずらす
+    void RemoveBit(int pos, int number_of_words)
+    {
+        int w = pos / WORD_BITS;
+        int b = pos % WORD_BITS;
+        uint64 low = bits[w] & ((static_cast<uint64>(1) << b) - 1);
+        uint64 high = (b == WORD_BITS - 1 ? 0 : (bits[w] >> (b + 1)) << b);
+        bits[w] = low | high;
+        for (int i = w + 1; i < number_of_words; ++i) {
+            bits[i - 1] |= (bits[i] & 1) << (WORD_BITS - 1);
+            bits[i] >>= 1;
+        }
+    }
+};
+
 template <typename FT, typename DT>
 class MateFD : public MateF<FT> {
 public:
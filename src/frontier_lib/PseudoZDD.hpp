@@ -24,6 +24,8 @@
 #include <vector>
 #include <map>
 #include <algorithm>
+#include <functional>
+#include <stdexcept>
 #include <cstdio>
 #include <cstdlib>
 #include <cstdarg>
@@ -32,10 +34,15 @@
 #include <iostream>
 #include <fstream>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "Global.hpp"
 #include "State.hpp"
 #include "ZDDNode.hpp"
 #include "SolutionArray.hpp"
+#include "Sampler.hpp"
 #include "Mate.hpp"
 #include "HashTable.hpp"
 
@@ -74,11 +81,18 @@ private:
     intx number_of_nodes_;
     bool hdd_mode_; // output constructed ZDD to a HDD.
     std::string hdd_filename_;
+    std::string reduced_hdd_filename_; // ReduceHddFile で書き出した既約な ZDD のファイル
     FILE* fp_;
     intx lo_node_;
+    intx reduced_size_; // ReduceFinishedLevels で最後に詰めた直後のノード数
+    bool is_discard_nodes_; // ノードの子を記録しない（FrontierAlgorithm::Evaluate 用）
 
     std::vector<EVElem> ev_array_;
 
+    // MakeLevelArray で作る表。ノードの配列が変わったら作り直す必要がある。
+    std::vector<int> level_array_; // level_array_[id]: ノード id のレベル（0 から始まる）
+    std::vector<bool> empty_array_; // empty_array_[id]: ノード id の表す集合族が空集合を含むか
+
     ZDDNode inner_parent_node_;
     ZDDNode inner_child_node_;
 
@@ -86,7 +100,9 @@ public:
     PseudoZDD() : solution_array_(NULL),
                   number_of_nodes_(2), // 0-terminal and 1-terminal
                   hdd_mode_(),
-                  fp_(NULL)
+                  fp_(NULL),
+                  reduced_size_(2),
+                  is_discard_nodes_(false)
     {
         node_array_.reserve(1 << 24);
 
@@ -142,6 +158,29 @@ public:
         return number_of_nodes_;
     }
 
+    const std::vector<std::pair<intx, intx> >& GetNodeArray() const
+    {
+        return node_array_;
+    }
+
+    const std::vector<intx>& GetLevelFirstArray() const
+    {
+        return level_first_array_;
+    }
+
+    // 構築済みのノードの配列を設定する（ZDDApply などで作った ZDD を格納するため）。
+    // ノードはレベル順に並び、level_first_array[i] がレベル i の先頭の番号でなければならない。
+    void SetNodeArray(const std::vector<std::pair<intx, intx> >& node_array,
+                      const std::vector<intx>& level_first_array)
+    {
+        node_array_ = node_array;
+        level_first_array_ = level_first_array;
+        number_of_nodes_ = static_cast<intx>(node_array_.size());
+        delete solution_array_;
+        solution_array_ = NULL;
+        ClearLevelArray();
+    }
+
     void SetHashTable(HashTable* global_hash_table)
     {
         global_hash_table_ = global_hash_table;
@@ -210,6 +249,11 @@ public:
         }
     }
 
+    void SetDiscardNodes()
+    {
+        is_discard_nodes_ = true;
+    }
+
     void HddTerminate()
     {
         if (hdd_mode_) {
@@ -219,6 +263,9 @@ public:
 
     void SetChildNode(ZDDNode* node, ZDDNode* child_node, int child_num)
     {
+        if (is_discard_nodes_) {
+            return;
+        }
         if (hdd_mode_) {
             if (child_num == 0) {
                 lo_node_ = child_node->node_number;
@@ -250,18 +297,47 @@ public:
         }
     }
 
-    int GetLevel(intx node_id)
+    // ノード node_id のレベル（1 から始まる）を返す。MakeLevelArray で表を作っておけば
+    // 表を引くだけで、そうでなければ level_first_array_ を二分探索する。
+    int GetLevel(intx node_id) const
     {
         if (node_id <= 1) {
             return 0;
         }
+        if (static_cast<uintx>(node_id) < level_array_.size()) {
+            return level_array_[node_id] + 1;
+        }
 
-        for (uint i = 0; i < level_first_array_.size() - 1; ++i) {
-            if (level_first_array_[i] <= node_id && node_id < level_first_array_[i + 1]) {
-                return i + 1;
-            }
+        // level_first_array_[i] <= node_id < level_first_array_[i + 1] のとき i + 1
+        return static_cast<int>(std::upper_bound(level_first_array_.begin(),
+                                                 level_first_array_.end(), node_id)
+                                - level_first_array_.begin());
+    }
+
+    // GetLevel と ContainsEmptySet が O(1) で答えられるように表を作る。
+    // サブセッティングに用いる ZDD など、構築済みで以後変更しない ZDD に対して呼び出す。
+    void MakeLevelArray()
+    {
+        MakeNodeLevelArray(node_array_, level_first_array_, &level_array_);
+        empty_array_.assign(node_array_.size(), false);
+        if (node_array_.size() >= 2) {
+            empty_array_[1] = true;
+        }
+        for (intx j = static_cast<intx>(node_array_.size()) - 1; j >= 2; --j) {
+            empty_array_[j] = empty_array_[node_array_[j].first];
+        }
+    }
+
+    // ノード node_id の表す集合族が空集合を含むか（lo 枝のみをたどって 1 終端に着くか）
+    bool ContainsEmptySet(intx node_id) const
+    {
+        if (static_cast<uintx>(node_id) < empty_array_.size()) {
+            return empty_array_[node_id];
         }
-        return static_cast<int>(level_first_array_.size());
+        while (node_id >= 2) {
+            node_id = node_array_[node_id].first;
+        }
+        return node_id == 1;
     }
 
     int GetMaxLevel() const
@@ -406,83 +482,143 @@ public:
         //}
         node_array_ = temp_array;
         number_of_nodes_ = temp_array.size();
+        ClearLevelArray();
         level_first_array_ = node_num_array;
     }
 
     void ReduceAsZDD()
     {
-        if (hdd_mode_) { // not implement
-            std::cerr << "ReduceAsZDD is not implemented." << std::endl;
+        if (hdd_mode_) {
+            ReduceHddFile(hdd_filename_ + ".reduced");
             return;
         }
-        std::vector<intx> temp_array;
-        std::vector<intx> node_count_array;
-        std::vector<intx> new_level_array;
+        ReduceLevels(static_cast<int>(level_first_array_.size()) - 2);
+    }
 
-        temp_array.resize(node_array_.size());
-        temp_array[0] = 0; // 0-terminal
-        temp_array[1] = 1; // 1-terminal
+    // 構築中に呼び出し、子が定まったレベルのノードを既約化して詰める。
+    // 前回詰めたときからノード数が 2 倍以上になった場合にのみ実行するので、
+    // 全体の計算量は構築したノード数に比例する。
+    void ReduceFinishedLevels()
+    {
+        if (hdd_mode_) {
+            return;
+        }
+        if (static_cast<intx>(node_array_.size()) >= 2 * reduced_size_) {
+            ReduceLevels(static_cast<int>(level_first_array_.size()) - 1);
+            reduced_size_ = node_array_.size();
+        }
+    }
 
-        node_count_array.resize(level_first_array_.size());
-        new_level_array.resize(level_first_array_.size());
-        new_level_array[0] = 2;
+    // hdd モードで書き出したファイルを下のレベルから順に読み込んで既約化し、
+    // OutputZDD と同じ形式でファイル filename に書き出す。
+    // メモリ上に置くのは、処理中のレベルのノードとその一意表、および
+    // 1 つ下のレベルのノードの既約化後の番号のみである。
+    void ReduceHddFile(const std::string& filename)
+    {
+        FILE* fin = OpenHddFile();
+        FILE* ftemp = tmpfile(); // 既約化したノードを下のレベルから順に格納する
+        if (ftemp == NULL) {
+            std::cerr << "error: temporary file cannot be created." << std::endl;
+            exit(1);
+        }
 
-        for (int i = static_cast<int>(level_first_array_.size()) - 3; i >= 0; --i) {
-            std::map<std::pair<intx, intx>, intx> node_map;
-            intx counter = level_first_array_[i];
-            for (intx j = level_first_array_[i]; j < level_first_array_[i + 1]; ++j) {
-                intx lo = temp_array[node_array_[j].first];
-                intx hi = temp_array[node_array_[j].second];
-                if (hi == 0) {
-                    temp_array[j] = lo;
+        std::vector<long> level_pos_array;
+        int number_of_levels = GetHddLevelPositions(fin, &level_pos_array);
+        char buff[256];
+
+        // 既約化したノードには、下のレベルから順に 2 から番号を付ける（下からの番号）。
+        // next_remap_array[k]: 1 つ下のレベルの k 番目のノードの既約化後の番号（下からの番号）
+        std::vector<intx> next_remap_array;
+        std::vector<intx> remap_array;
+        std::vector<intx> rep_array;
+        std::vector<intx> node_count_array(number_of_levels);
+        intx bottom_count = 2;
+
+        for (int i = number_of_levels - 1; i >= 0; --i) {
+            fseek(fin, level_pos_array[i], SEEK_SET);
+            node_array_.resize(2);
+            while (fgets(buff, sizeof(buff), fin) != NULL && buff[0] != '#') {
+                intx id, lo, hi;
+                sscanf(buff, PERCENT_D ":" PERCENT_D "," PERCENT_D, &id, &lo, &hi);
+                assert(id == static_cast<intx>(node_array_.size()) - 2);
+                lo = (lo >= 0 ? next_remap_array[lo] : ZeroTerminal->node_number - lo);
+                hi = (hi >= 0 ? next_remap_array[hi] : ZeroTerminal->node_number - hi);
+                node_array_.push_back(std::make_pair(lo, hi));
+            }
+            intx last = node_array_.size();
+
+            rep_array.resize(last);
+            FindRepresentatives(2, last, &rep_array);
+
+            remap_array.resize(last - 2);
+            intx counter = 0;
+            for (intx j = 2; j < last; ++j) {
+                if (node_array_[j].second == 0) { // zero-suppressed rule
+                    remap_array[j - 2] = node_array_[j].first;
+                } else if (rep_array[j] == j) { // 同じ (lo, hi) を持つノードのうち最初のもの
+                    fwrite(&node_array_[j], sizeof(node_array_[j]), 1, ftemp);
+                    remap_array[j - 2] = bottom_count + counter;
+                    ++counter;
                 } else {
-                    std::map<std::pair<intx, intx>, intx>::iterator itor = node_map.find(std::make_pair(lo, hi));
-                    if (itor != node_map.end()) { // element found
-                        temp_array[j] = (*itor).second;
-                    } else {
-                        temp_array[j] = counter;
-                        node_map.insert(std::make_pair(std::make_pair(lo, hi), counter));
-                        node_array_[counter].first = lo;
-                        node_array_[counter].second = hi;
-                        ++counter;
-                    }
+                    remap_array[j - 2] = remap_array[rep_array[j] - 2];
                 }
             }
-            node_count_array[i] = counter - level_first_array_[i];
+            node_count_array[i] = counter;
+            bottom_count += counter;
+            next_remap_array.swap(remap_array);
         }
+        fclose(fin);
 
-        intx sum = 2;
-        for (uint i = 0; i < level_first_array_.size() - 2; ++i) {
-            sum += node_count_array[i];
-            new_level_array[i + 1] = sum;
+        // bottom_first_array[i]: レベル i の先頭ノードの下からの番号
+        // new_level_array[i]: レベル i の先頭ノードの最終的な番号
+        std::vector<intx> bottom_first_array(number_of_levels);
+        std::vector<intx> new_level_array(number_of_levels + 1);
+        new_level_array[0] = 2;
+        for (int i = 0; i < number_of_levels; ++i) {
+            new_level_array[i + 1] = new_level_array[i] + node_count_array[i];
+            bottom_first_array[i] = bottom_count - new_level_array[i + 1] + 2;
         }
-        new_level_array[new_level_array.size() - 1] = new_level_array[new_level_array.size() - 2];
-
-        std::map<intx, intx> node_map;
-        node_map.insert(std::make_pair(0, 0));
-        node_map.insert(std::make_pair(1, 1));
 
-        for (uint i = 0; i < new_level_array.size() - 2; ++i) {
-            for (intx j = new_level_array[i]; j < new_level_array[i + 1]; ++j) {
-                node_map.insert(std::make_pair(level_first_array_[i] + j - new_level_array[i], j));
-                node_array_[j] = node_array_[level_first_array_[i] + j - new_level_array[i]];
-            }
+        FILE* fout = fopen(filename.c_str(), "w");
+        if (fout == NULL) {
+            std::cerr << "error: file " << filename << " cannot be opened." << std::endl;
+            exit(1);
         }
-
-        for (uint i = 2; i < node_array_.size(); ++i) {
-            node_array_[i].first = node_map[node_array_[i].first];
-            node_array_[i].second = node_map[node_array_[i].second];
+        for (int i = 0; i < number_of_levels; ++i) {
+            fprintf(fout, "#%d:\n", i + 1);
+            if (node_count_array[i] == 0) {
+                continue;
+            }
+            node_array_.resize(node_count_array[i]);
+            fseek(ftemp, static_cast<long>((bottom_first_array[i] - 2) * sizeof(node_array_[0])),
+                  SEEK_SET);
+            if (fread(&node_array_[0], sizeof(node_array_[0]), node_array_.size(), ftemp)
+                    != node_array_.size()) {
+                std::cerr << "error: temporary file cannot be read." << std::endl;
+                exit(1);
+            }
+            for (intx k = 0; k < node_count_array[i]; ++k) {
+                fprintf(fout, PERCENT_D ":" PERCENT_D "," PERCENT_D "\n", new_level_array[i] + k,
+                        TranslateBottomNumber(node_array_[k].first, bottom_first_array, new_level_array),
+                        TranslateBottomNumber(node_array_[k].second, bottom_first_array, new_level_array));
+            }
         }
+        fclose(fout);
+        fclose(ftemp);
 
-        node_array_.resize(new_level_array.back());
-        number_of_nodes_ = node_array_.size();
-        //std::vector<ZDDNode>().swap(node_array_);
-
+        node_array_.resize(2);
+        number_of_nodes_ = bottom_count;
         level_first_array_ = new_level_array;
+        level_first_array_.push_back(bottom_count);
+        reduced_hdd_filename_ = filename;
     }
 
     void OutputZDD(FILE* fp, bool is_hex = false) const
     {
+        if (hdd_mode_) {
+            OutputReducedHddFile(fp, is_hex);
+            return;
+        }
         if (is_hex) {
             for (uint i = 0; i < level_first_array_.size() - 1 - 1; ++i) { // ignore terminals
                 fprintf(fp, "#%d:\n", i + 1);
@@ -585,19 +721,75 @@ public:
         Enumerate(2, &vec, use_array, callback);
     }
 
+    // 解を一様ランダムに sample_num 個取り出して fp に出力する。
+    // 同じ seed を与えれば、スレッド数によらず同じ出力が得られる。
+    void OutputSamplingSolutions(FILE* fp, int sample_num, uint64 seed)
+    {
+        UniformSampler<uintx> sampler(node_array_, level_first_array_);
+        if (!sampler.IsOverflow()) {
+            sampler.OutputSamples(fp, sample_num, seed);
+        } else {
+            UniformSampler<BigInteger> big_sampler(node_array_, level_first_array_);
+            big_sampler.OutputSamples(fp, sample_num, seed);
+        }
+    }
+
     void OutputSamplingSolutions(FILE* fp, int sample_num)
     {
-        for (int i = 0; i < sample_num; ++i) {
-            std::vector<int> vec;
-            SampleUniformlyRandomly(&vec);
-            for (uint j = 0; j < vec.size(); ++j) {
-                fprintf(fp, "%d", vec[j]);
-                if (j < vec.size() - 1) {
-                    fprintf(fp, " ");
-                }
-            }
-            fprintf(fp, "\n");
+        OutputSamplingSolutions(fp, sample_num, static_cast<uint64>(rand()));
+    }
+
+    // 変数 i の重みを exp(log_weight_array[i - 1]) として、重みの積に比例する確率で
+    // 解を sample_num 個取り出して fp に出力する
+    void OutputWeightedSamplingSolutions(FILE* fp, int sample_num, uint64 seed,
+                                         const std::vector<double>& log_weight_array)
+    {
+        BoltzmannSampler sampler(node_array_, level_first_array_, log_weight_array);
+        sampler.OutputSamples(fp, sample_num, seed);
+    }
+
+    // 変数 i の重みを weight_array[i - 1] として、重みの和が小さい順（is_max が true なら
+    // 大きい順）に k 個の解を fp に出力する。各行は「重みの和: 変数の番号の列」である。
+    // 出力した解の個数を返す。
+    intx OutputOptimalSolutions(FILE* fp, intx k, const std::vector<intx>& weight_array,
+                                bool is_max)
+    {
+        OptimalCalculator calculator(node_array_, level_first_array_, weight_array, is_max);
+        std::string buffer;
+        std::vector<int> vec;
+        intx weight;
+        intx rank = 0;
+        for (; rank < k && calculator.GetSolution(rank, &weight, &vec); ++rank) {
+            AppendSolutionLine(&weight, 1, vec, &buffer, fp);
+        }
+        fwrite(buffer.data(), 1, buffer.size(), fp);
+        return rank;
+    }
+
+    // 変数 i の重みを (weight1_array[i - 1], weight2_array[i - 1]) として、重みの和が Pareto 最適な
+    // 解を 1 つ目の重みの和の昇順に fp に出力する。各行は「重み 1 の和 重み 2 の和: 変数の番号
+    // の列」である。出力した解の個数を返す。
+    intx OutputParetoSolutions(FILE* fp, const std::vector<intx>& weight1_array,
+                               const std::vector<intx>& weight2_array)
+    {
+        ParetoCalculator calculator(node_array_, level_first_array_, weight1_array,
+                                    weight2_array);
+        std::string buffer;
+        std::vector<int> vec;
+        for (intx i = 0; i < calculator.GetNumberOfSolutions(); ++i) {
+            intx value_array[2];
+            calculator.GetSolution(i, &value_array[0], &value_array[1], &vec);
+            AppendSolutionLine(value_array, 2, vec, &buffer, fp);
         }
+        fwrite(buffer.data(), 1, buffer.size(), fp);
+        return calculator.GetNumberOfSolutions();
+    }
+
+    // 全解の重みの積の和の対数を返す
+    double ComputeLogPartitionFunction(const std::vector<double>& log_weight_array)
+    {
+        BoltzmannSampler sampler(node_array_, level_first_array_, log_weight_array);
+        return sampler.GetLogPartitionFunction();
     }
 
     // 引数に与えるリストはソートされていなければならない
@@ -647,14 +839,18 @@ public:
         return current_node == 1;
     }
 
+    // 解を 1 つ一様ランダムに取り出す。呼び出しのたびに解の数を数え直すので、
+    // 多数の解を取り出す場合は OutputSamplingSolutions を用いること。
     void SampleUniformlyRandomly(std::vector<int>* result)
     {
-        if (solution_array_ == NULL) {
-            SolutionArrayDerive<double>* solution_array = new SolutionArrayDerive<double>;
-            solution_array_ = solution_array;
-            solution_array->ComputeNumberOfSolutions(node_array_);
+        Random64 random(static_cast<uint64>(rand()));
+        UniformSampler<uintx> sampler(node_array_, level_first_array_);
+        if (!sampler.IsOverflow()) {
+            sampler.Sample(&random, result);
+        } else {
+            UniformSampler<BigInteger> big_sampler(node_array_, level_first_array_);
+            big_sampler.Sample(&random, result);
         }
-        solution_array_->SampleUniformlyRandomly(node_array_, level_first_array_, result);
     }
 
     void ImportZDD(std::istream& ist, bool is_hex)
@@ -663,6 +859,7 @@ public:
         intx count = 2;
         std::string s;
         node_array_.clear();
+        ClearLevelArray();
 
         // create dummy ZeroNode
         node_array_.push_back(std::make_pair(-1, -1));
@@ -694,9 +891,499 @@ public:
             }
         }
         level_first_array_.push_back(count);
+        number_of_nodes_ = count;
+        MakeLevelArray();
+    }
+
+    // value_array[i] が 1 の変数を含み、0 の変数を含まない解のみからなる既約な ZDD を作って返す。
+    // value_array[i] が負の変数と、value_array の範囲外の変数は制限しない。
+    // 元の ZDD の各ノードを下のレベルから 1 度ずつ処理し、同じレベルで (lo, hi) が等しいノードは
+    // ハッシュ表で共有するので、計算量はノード数にほぼ比例する。
+    // 結果が空集合族または {空集合} の場合、根は 0-終端または 1-終端を lo 子に持つノードとする。
+    PseudoZDD* Restrict(const std::vector<int>& value_array) const
+    {
+        assert(!hdd_mode_);
+
+        int number_of_levels = static_cast<int>(level_first_array_.size()) - 1;
+        std::vector<int> level_array;
+        std::vector<int> one_count_array;
+        GetLevelArray(&level_array);
+        GetOneCountArray(value_array, &one_count_array);
+
+        // 制限を反映したノードを元と同じ番号の位置に作り、下のレベルから既約化する。
+        // remap_array[j]: ノード j の既約化後の番号（既約化後のノードも元の位置に置く）
+        PseudoZDD* zdd = new PseudoZDD;
+        zdd->node_array_ = node_array_;
+        std::vector<intx> remap_array(node_array_.size());
+        remap_array[0] = 0;
+        remap_array[1] = 1;
+        for (int i = number_of_levels - 1; i >= 0; --i) {
+            intx first = level_first_array_[i];
+            intx last = level_first_array_[i + 1];
+            int value = (i < static_cast<int>(value_array.size()) ? value_array[i] : -1);
+            for (intx j = first; j < last; ++j) {
+                std::pair<intx, intx>& node = zdd->node_array_[j];
+                node.first = (value == 1 || IsBlocked(i, node.first, level_array, one_count_array)
+                              ? 0 : remap_array[node.first]);
+                node.second = (value == 0 || IsBlocked(i, node.second, level_array, one_count_array)
+                               ? 0 : remap_array[node.second]);
+            }
+            zdd->FindRepresentatives(first, last, &remap_array);
+            for (intx j = first; j < last; ++j) {
+                if (zdd->node_array_[j].second == 0) { // zero-suppressed rule
+                    remap_array[j] = zdd->node_array_[j].first;
+                }
+            }
+        }
+        intx root = (IsBlocked(-1, 2, level_array, one_count_array) ? 0 : remap_array[2]);
+
+        // 根から到達できるノードのみをレベル順に詰める
+        std::vector<std::pair<intx, intx> > new_node_array(2, std::make_pair(-1, -1));
+        std::vector<intx> new_level_array(number_of_levels + 1);
+        if (root < 2) {
+            new_node_array.push_back(std::make_pair(root, 0));
+            new_level_array[0] = 2;
+            for (int i = 1; i <= number_of_levels; ++i) {
+                new_level_array[i] = 3;
+            }
+        } else {
+            std::vector<bool> reachable_array(node_array_.size());
+            reachable_array[root] = true;
+            for (int i = 0; i < number_of_levels; ++i) {
+                new_level_array[i] = static_cast<intx>(new_node_array.size());
+                for (intx j = level_first_array_[i]; j < level_first_array_[i + 1]; ++j) {
+                    if (reachable_array[j]) {
+                        remap_array[j] = static_cast<intx>(new_node_array.size());
+                        new_node_array.push_back(zdd->node_array_[j]);
+                        reachable_array[zdd->node_array_[j].first] = true;
+                        reachable_array[zdd->node_array_[j].second] = true;
+                    }
+                }
+            }
+            new_level_array[number_of_levels] = static_cast<intx>(new_node_array.size());
+            for (uintx j = 2; j < new_node_array.size(); ++j) {
+                new_node_array[j].first = remap_array[new_node_array[j].first];
+                new_node_array[j].second = remap_array[new_node_array[j].second];
+            }
+        }
+        zdd->node_array_.swap(new_node_array);
+        zdd->level_first_array_ = new_level_array;
+        zdd->number_of_nodes_ = static_cast<intx>(zdd->node_array_.size());
+        return zdd;
+    }
+
+    // 変数 var を含む解のみからなる ZDD を返す
+    PseudoZDD* Onset(int var) const
+    {
+        std::vector<int> value_array(var + 1, -1);
+        value_array[var] = 1;
+        return Restrict(value_array);
+    }
+
+    // 変数 var を含まない解のみからなる ZDD を返す
+    PseudoZDD* Offset(int var) const
+    {
+        std::vector<int> value_array(var + 1, -1);
+        value_array[var] = 0;
+        return Restrict(value_array);
+    }
+
+    // Restrict(value_array) が表す解の個数を、ZDD を作らずに 1 度の走査で求める
+    template <typename T>
+    T ComputeNumberOfRestrictedSolutions(const std::vector<int>& value_array) const
+    {
+        assert(!hdd_mode_);
+
+        int number_of_levels = static_cast<int>(level_first_array_.size()) - 1;
+        std::vector<int> level_array;
+        std::vector<int> one_count_array;
+        GetLevelArray(&level_array);
+        GetOneCountArray(value_array, &one_count_array);
+
+        std::vector<T> count_array(node_array_.size());
+        count_array[0] = 0;
+        count_array[1] = 1;
+        for (int i = number_of_levels - 1; i >= 0; --i) {
+            int value = (i < static_cast<int>(value_array.size()) ? value_array[i] : -1);
+            for (intx j = level_first_array_[i]; j < level_first_array_[i + 1]; ++j) {
+                if (value != 1 && !IsBlocked(i, node_array_[j].first, level_array, one_count_array)) {
+                    count_array[j] += count_array[node_array_[j].first];
+                }
+                if (value != 0 && !IsBlocked(i, node_array_[j].second, level_array, one_count_array)) {
+                    count_array[j] += count_array[node_array_[j].second];
+                }
+            }
+        }
+        if (node_array_.size() <= 2 || IsBlocked(-1, 2, level_array, one_count_array)) {
+            return T();
+        }
+        return count_array[2];
     }
 
 private:
+    // 「values[0] ... values[n - 1]: 解の変数の番号の列」の 1 行を buffer に追加する。
+    // buffer が一定の大きさを超えたら fp に書き出す（最後の書き出しは呼び出し側で行う）。
+    static void AppendSolutionLine(const intx* values, int n, const std::vector<int>& vec,
+                                   std::string* buffer, FILE* fp)
+    {
+        for (int i = 0; i < n; ++i) {
+            char str[32];
+            sprintf(str, (i == 0 ? "%lld" : " %lld"), static_cast<long long int>(values[i]));
+            *buffer += str;
+        }
+        *buffer += ':';
+        for (uint j = 0; j < vec.size(); ++j) {
+            *buffer += ' ';
+            AppendNumber(vec[j], buffer);
+        }
+        *buffer += '\n';
+        if (buffer->size() >= (1 << 16)) {
+            fwrite(buffer->data(), 1, buffer->size(), fp);
+            buffer->clear();
+        }
+    }
+
+    void ClearLevelArray()
+    {
+        level_array_.clear();
+        empty_array_.clear();
+    }
+
+    // (*level_array)[id]: ノード id のレベル。終端のレベルは最後のレベルの次とする。
+    void GetLevelArray(std::vector<int>* level_array) const
+    {
+        MakeNodeLevelArray(node_array_, level_first_array_, level_array);
+        (*level_array)[0] = (*level_array)[1] = static_cast<int>(level_first_array_.size()) - 1;
+    }
+
+    // (*one_count_array)[i]: レベル 0 から i - 1 までのうち、1 に固定された変数の個数
+    void GetOneCountArray(const std::vector<int>& value_array,
+                          std::vector<int>* one_count_array) const
+    {
+        int number_of_levels = static_cast<int>(level_first_array_.size()) - 1;
+        one_count_array->assign(number_of_levels + 1, 0);
+        for (int i = 0; i < number_of_levels; ++i) {
+            (*one_count_array)[i + 1] = (*one_count_array)[i]
+                + (i < static_cast<int>(value_array.size()) && value_array[i] == 1 ? 1 : 0);
+        }
+    }
+
+    // レベル level のノードから子 child への枝が、1 に固定された変数のレベルを飛ばしているか。
+    // 飛ばされた変数は使われないので、そのような枝の先の解は制限を満たさない。
+    static bool IsBlocked(int level, intx child, const std::vector<int>& level_array,
+                          const std::vector<int>& one_count_array)
+    {
+        return child != 0 && one_count_array[level_array[child]] > one_count_array[level + 1];
+    }
+
+    // レベル 0 から number_of_levels - 1 までのノードを既約化して詰める。
+    // 番号が level_first_array_[number_of_levels] 以上のノードは子が定まっていないものとして
+    // 既約化の対象とせず、詰めた分だけ番号をずらす。
+    void ReduceLevels(int number_of_levels)
+    {
+        ClearLevelArray();
+
+        intx limit = level_first_array_[number_of_levels];
+
+        // remap_array[j]: ノード j の既約化後の番号
+        std::vector<intx> remap_array(limit);
+        std::vector<intx> node_count_array(number_of_levels);
+        std::vector<intx> new_level_array(number_of_levels + 1);
+
+        remap_array[0] = 0; // 0-terminal
+        remap_array[1] = 1; // 1-terminal
+
+        // 下のレベルから順に、各レベルのノードを既約化してレベルの先頭に詰める。
+        // この段階では、ノードの番号は詰めた後の位置で表す。
+        for (int i = number_of_levels - 1; i >= 0; --i) {
+            intx first = level_first_array_[i];
+            intx last = level_first_array_[i + 1];
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (intx j = first; j < last; ++j) {
+                if (node_array_[j].first < limit) {
+                    node_array_[j].first = remap_array[node_array_[j].first];
+                }
+                if (node_array_[j].second < limit) {
+                    node_array_[j].second = remap_array[node_array_[j].second];
+                }
+            }
+
+            FindRepresentatives(first, last, &remap_array);
+
+            intx counter = first;
+            for (intx j = first; j < last; ++j) {
+                if (node_array_[j].second == 0) { // zero-suppressed rule
+                    remap_array[j] = node_array_[j].first;
+                } else if (remap_array[j] == j) { // 同じ (lo, hi) を持つノードのうち最初のもの
+                    node_array_[counter] = node_array_[j];
+                    remap_array[j] = counter;
+                    ++counter;
+                } else {
+                    remap_array[j] = remap_array[remap_array[j]];
+                }
+            }
+            node_count_array[i] = counter - first;
+        }
+
+        new_level_array[0] = 2;
+        for (int i = 0; i < number_of_levels; ++i) {
+            new_level_array[i + 1] = new_level_array[i] + node_count_array[i];
+        }
+        intx shift = limit - new_level_array[number_of_levels];
+
+        // 詰めた後の位置から最終的な番号への対応を remap_array に格納し直す
+        for (int i = 0; i < number_of_levels; ++i) {
+            for (intx k = 0; k < node_count_array[i]; ++k) {
+                remap_array[level_first_array_[i] + k] = new_level_array[i] + k;
+            }
+        }
+
+        // 最終的な位置は元の位置以前なので、前から順に移動してよい
+        for (int i = 0; i < number_of_levels; ++i) {
+            intx first = level_first_array_[i];
+            intx count = node_count_array[i];
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (intx k = 0; k < count; ++k) {
+                std::pair<intx, intx>& node = node_array_[first + k];
+                node.first = (node.first < limit ? remap_array[node.first] : node.first - shift);
+                node.second = (node.second < limit ? remap_array[node.second] : node.second - shift);
+            }
+            std::copy(node_array_.begin() + first, node_array_.begin() + first + count,
+                      node_array_.begin() + new_level_array[i]);
+        }
+
+        node_array_.resize(new_level_array[number_of_levels]);
+        number_of_nodes_ -= shift;
+
+        for (int i = 0; i <= number_of_levels; ++i) {
+            level_first_array_[i] = new_level_array[i];
+        }
+        for (uint i = number_of_levels + 1; i < level_first_array_.size(); ++i) {
+            level_first_array_[i] -= shift;
+        }
+    }
+
+    FILE* OpenHddFile() const
+    {
+        FILE* fin = fopen(hdd_filename_.c_str(), "r");
+        if (fin == NULL) {
+            std::cerr << "error: file " << hdd_filename_ << " cannot be opened." << std::endl;
+            exit(1);
+        }
+        return fin;
+    }
+
+    // hdd モードで書き出したファイルの各レベルの先頭のファイル位置を調べ、レベル数を返す。
+    // 最後の "#" 行は終端のレベルなので、ノードは書かれていない。
+    static int GetHddLevelPositions(FILE* fin, std::vector<long>* level_pos_array)
+    {
+        char buff[256];
+        while (fgets(buff, sizeof(buff), fin) != NULL) {
+            if (buff[0] == '#') {
+                level_pos_array->push_back(ftell(fin));
+            }
+        }
+        return std::max(static_cast<int>(level_pos_array->size()) - 1, 0);
+    }
+
+    template <typename T>
+    struct Plus {
+        T operator()(const T& a, const T& b) const
+        {
+            T c = a;
+            c += b;
+            return c;
+        }
+    };
+
+    struct PlusOF {
+        uintx operator()(uintx a, uintx b) const
+        {
+            if (b > UINTX_MAX - a) { // overflow
+                throw std::overflow_error("overflow!");
+            }
+            return a + b;
+        }
+    };
+
+    // hdd モードで書き出したファイルを下のレベルから順に読み込み、解の数を計算する。
+    // ノードの子は 1 つ下のレベルか終端にしかないので、
+    // メモリ上に置くのは隣接する 2 つのレベルのノードの解の数のみである。
+    template <typename T, typename Add>
+    T ComputeNumberOfSolutionsOnHdd(Add add) const
+    {
+        FILE* fin = OpenHddFile();
+        std::vector<long> level_pos_array;
+        int number_of_levels = GetHddLevelPositions(fin, &level_pos_array);
+
+        T terminal_array[2];
+        terminal_array[0] = 0;
+        terminal_array[1] = 1;
+
+        std::vector<T> next_array; // 1 つ下のレベルのノードの解の数
+        std::vector<T> current_array;
+        char buff[256];
+
+        for (int i = number_of_levels - 1; i >= 0; --i) {
+            fseek(fin, level_pos_array[i], SEEK_SET);
+            current_array.clear();
+            while (fgets(buff, sizeof(buff), fin) != NULL && buff[0] != '#') {
+                intx id, lo, hi;
+                sscanf(buff, PERCENT_D ":" PERCENT_D "," PERCENT_D, &id, &lo, &hi);
+                assert(id == static_cast<intx>(current_array.size()));
+                current_array.push_back(add(lo >= 0 ? next_array[lo]
+                                            : terminal_array[ZeroTerminal->node_number - lo],
+                                            hi >= 0 ? next_array[hi]
+                                            : terminal_array[ZeroTerminal->node_number - hi]));
+            }
+            next_array.swap(current_array);
+        }
+        fclose(fin);
+
+        if (next_array.empty()) {
+            return T();
+        }
+        return next_array[0]; // root
+    }
+
+    // 下からの番号 id を持つノードの最終的な番号を返す。
+    // bottom_first_array はレベルについて降順なので、先頭ノードの番号が id 以下である
+    // 最初のレベルが id を含むレベルである。
+    static intx TranslateBottomNumber(intx id, const std::vector<intx>& bottom_first_array,
+                                      const std::vector<intx>& new_level_array)
+    {
+        if (id < 2) { // terminal
+            return id;
+        }
+        intx level = std::lower_bound(bottom_first_array.begin(), bottom_first_array.end(),
+                                      id, std::greater<intx>()) - bottom_first_array.begin();
+        return new_level_array[level] + (id - bottom_first_array[level]);
+    }
+
+    void OutputReducedHddFile(FILE* fp, bool is_hex) const
+    {
+        if (reduced_hdd_filename_.empty()) {
+            std::cerr << "OutputZDD is not implemented for an unreduced ZDD on a HDD." << std::endl;
+            return;
+        }
+        FILE* fin = fopen(reduced_hdd_filename_.c_str(), "r");
+        if (fin == NULL) {
+            std::cerr << "error: file " << reduced_hdd_filename_ << " cannot be opened." << std::endl;
+            exit(1);
+        }
+        char buff[256];
+        while (fgets(buff, sizeof(buff), fin) != NULL) {
+            intx id, lo, hi;
+            if (is_hex && buff[0] != '#') {
+                sscanf(buff, PERCENT_D ":" PERCENT_D "," PERCENT_D, &id, &lo, &hi);
+                fprintf(fp, PERCENT_X ":" PERCENT_X "," PERCENT_X "\n", id, lo, hi);
+            } else {
+                fputs(buff, fp);
+            }
+        }
+        fclose(fin);
+    }
+
+    static uintx GetHashValueOfNode(const std::pair<intx, intx>& node)
+    {
+        uintx hash_value = static_cast<uintx>(node.first) * 15284356289ll
+            + static_cast<uintx>(node.second);
+        return hash_value ^ (hash_value >> 31);
+    }
+
+    // [first, last) のノードのうち、hi 枝が 0 終端でないものについて、
+    // 同じ (lo, hi) を持つノードの中で番号が最小のものを (*rep_array)[j] に格納する。
+    // ノードをハッシュ値で分割し、スレッドごとに別々のハッシュ表で処理する。
+    // 各スレッドは [first, last) を T 等分した区間を 1 度だけ走査してハッシュ値を計算し、
+    // 分割ごとの個数の累積和を使ってノード番号を分割ごとに（番号の昇順に）並べる。
+    // その後、各スレッドは自分の分割に属するノードだけを処理する。
+    void FindRepresentatives(intx first, intx last, std::vector<intx>* rep_array) const
+    {
+        int number_of_threads = 1;
+#ifdef _OPENMP
+        number_of_threads = omp_get_max_threads();
+#endif
+        intx size = last - first;
+        std::vector<uintx> hash_array(size);
+        std::vector<intx> order_array(size);
+        // count_array[c * T + t] は c 番目の区間に含まれ、t 番目の分割に属するノードの個数。
+        // 累積和をとった後は、それらのノードを order_array に書き込む開始位置になる。
+        std::vector<intx> count_array(static_cast<size_t>(number_of_threads) * number_of_threads, 0);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1)
+#endif
+        for (int c = 0; c < number_of_threads; ++c) {
+            intx chunk_first = first + size * c / number_of_threads;
+            intx chunk_last = first + size * (c + 1) / number_of_threads;
+            for (intx j = chunk_first; j < chunk_last; ++j) {
+                if (node_array_[j].second == 0) {
+                    continue;
+                }
+                uintx hash_value = GetHashValueOfNode(node_array_[j]);
+                hash_array[j - first] = hash_value;
+                ++count_array[c * number_of_threads + hash_value % number_of_threads];
+            }
+        }
+
+        // 分割の番号を優先して累積和をとる（分割 t の中では区間の順、すなわちノード番号の昇順）
+        std::vector<intx> bucket_first_array(number_of_threads + 1);
+        intx sum = 0;
+        for (int t = 0; t < number_of_threads; ++t) {
+            bucket_first_array[t] = sum;
+            for (int c = 0; c < number_of_threads; ++c) {
+                intx count = count_array[c * number_of_threads + t];
+                count_array[c * number_of_threads + t] = sum;
+                sum += count;
+            }
+        }
+        bucket_first_array[number_of_threads] = sum;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1)
+#endif
+        for (int c = 0; c < number_of_threads; ++c) {
+            intx chunk_first = first + size * c / number_of_threads;
+            intx chunk_last = first + size * (c + 1) / number_of_threads;
+            for (intx j = chunk_first; j < chunk_last; ++j) {
+                if (node_array_[j].second == 0) {
+                    continue;
+                }
+                int t = static_cast<int>(hash_array[j - first] % number_of_threads);
+                order_array[count_array[c * number_of_threads + t]++] = j;
+            }
+        }
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1)
+#endif
+        for (int t = 0; t < number_of_threads; ++t) {
+            intx count = bucket_first_array[t + 1] - bucket_first_array[t];
+            uintx table_size = 1;
+            while (table_size < static_cast<uintx>(count) * 2) {
+                table_size <<= 1;
+            }
+            std::vector<intx> table(table_size, -1);
+
+            for (intx i = bucket_first_array[t]; i < bucket_first_array[t + 1]; ++i) {
+                intx j = order_array[i];
+                uintx k = (hash_array[j - first] / number_of_threads) & (table_size - 1);
+                while (table[k] >= 0 && node_array_[table[k]] != node_array_[j]) {
+                    k = (k + 1) & (table_size - 1);
+                }
+                if (table[k] < 0) {
+                    table[k] = j;
+                }
+                (*rep_array)[j] = table[k];
+            }
+        }
+    }
+
     void OutputElementRecursively(intx id, std::vector<int>* vec, FILE* fp) const
     {
         if (id == 0) {
@@ -763,27 +1450,85 @@ public:
     template <typename T>
     T ComputeNumberOfSolutions()
     {
-        if (hdd_mode_) { // not implement
-            std::cerr << "ComputeNumberOfSolutions is not implemented." << std::endl;
-            return T();
+        if (hdd_mode_) {
+            return ComputeNumberOfSolutionsOnHdd<T>(Plus<T>());
         }
         delete solution_array_;
         SolutionArrayDerive<T>* solution_array = new SolutionArrayDerive<T>;
         solution_array_ = solution_array;
-        return solution_array->ComputeNumberOfSolutions(node_array_);
+        return solution_array->ComputeNumberOfSolutions(node_array_, level_first_array_);
     }
 
-    uintx ComputeNumberOfSolutionsOF()
+    // 複数の素数を法として解の数を数え、中国剰余定理で復元する
+    BigInteger ComputeNumberOfSolutionsByCRT()
     {
         if (hdd_mode_) { // not implement
-            std::cerr << "ComputeNumberOfSolutionsOF is not implemented." << std::endl;
-            return 0;
+            std::cerr << "ComputeNumberOfSolutionsByCRT is not implemented." << std::endl;
+            return BigInteger();
+        }
+        ModularCounter counter(static_cast<int>(level_first_array_.size()) - 2);
+        return counter.ComputeNumberOfSolutions(node_array_);
+    }
+
+    // レベルごとに必要な桁数を選びながら解の数を数える
+    BigInteger ComputeNumberOfSolutionsAdaptively()
+    {
+        if (hdd_mode_) { // not implement
+            std::cerr << "ComputeNumberOfSolutionsAdaptively is not implemented." << std::endl;
+            return BigInteger();
+        }
+        AdaptiveCounter counter(node_array_, level_first_array_);
+        return counter.ComputeNumberOfSolutions();
+    }
+
+    // 解を辺の重みの総和で分類した母関数の係数を (*result)[k] に格納する。
+    // weight_array[i] は i 番目の変数（辺）の重み。
+    template <typename T>
+    void ComputeGeneratingFunction(const std::vector<int>& weight_array, std::vector<T>* result)
+    {
+        if (hdd_mode_) { // not implement
+            std::cerr << "ComputeGeneratingFunction is not implemented." << std::endl;
+            return;
+        }
+        GeneratingFunctionCalculator<T> calculator(node_array_, level_first_array_);
+        calculator.Compute(weight_array, result);
+    }
+
+    // 変数 i を含む解の個数を (*result)[i] に格納し、解の総数を返す
+    template <typename T>
+    T ComputeMarginals(std::vector<T>* result)
+    {
+        if (hdd_mode_) { // not implement
+            std::cerr << "ComputeMarginals is not implemented." << std::endl;
+            return T();
+        }
+        MarginalCalculator<T> calculator(node_array_, level_first_array_);
+        return calculator.Compute(result);
+    }
+
+    // 各辺が独立に確率 probability_matrix[i][s] で使われるとき、使われる辺の集合が
+    // 解となる確率を、各シナリオ s について (*result)[s] に格納する。
+    void ComputeReliabilities(const std::vector<std::vector<double> >& probability_matrix,
+                              int number_of_scenarios, std::vector<double>* result)
+    {
+        if (hdd_mode_) { // not implement
+            std::cerr << "ComputeReliabilities is not implemented." << std::endl;
+            return;
+        }
+        ReliabilityCalculator calculator(node_array_, level_first_array_);
+        calculator.Compute(probability_matrix, number_of_scenarios, result);
+    }
+
+    uintx ComputeNumberOfSolutionsOF()
+    {
+        if (hdd_mode_) {
+            return ComputeNumberOfSolutionsOnHdd<uintx>(PlusOF());
         }
         delete solution_array_;
         SolutionArrayDerive<uintx>* solution_array = new SolutionArrayDerive<uintx>;
         solution_array_ = solution_array;
         try {
-            return solution_array->ComputeNumberOfSolutionsOF(node_array_);
+            return solution_array->ComputeNumberOfSolutionsOF(node_array_, level_first_array_);
         } catch (...) {
             delete solution_array_;
             solution_array_ = NULL;
@@ -0,0 +1,306 @@
+//
+// RestGraphManager.hpp
+//
+// Copyright (c) 2012 -- 2016 Jun Kawahara
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef RESTGRAPHMANAGER_HPP
+#define RESTGRAPHMANAGER_HPP
+
+#include <vector>
+
+#include "Graph.hpp"
+#include "FrontierManager.hpp"
+
+namespace frontier_lib {
+
+//*************************************************************************************************
+// RestGraphManager: 未処理の辺からなるグラフ（残りグラフ）を管理し、
+// 先読みによる枝刈り判定を行うクラス。
+// 残りグラフのうちフロンティアに含まれない頂点の連結成分は辺ごとに Update で前計算し、
+// 各ノードではフロンティアの頂点とそれらの連結成分のみからなる小さなグラフを考える。
+class RestGraphManager {
+public:
+    // フロンティアの頂点の種類
+    enum {
+        SATURATED = 0, // これ以上辺を接続できない頂点
+        ENDPOINT = 1, // ちょうど1本の辺をさらに接続する必要がある頂点（パスの端点）
+        ISOLATED = 2 // まだ辺が接続されておらず、通過点にもなり得る頂点
+    };
+
+private:
+    const Graph* const graph_;
+
+    // 未処理の間は端点として扱う頂点（s-t パスの s, t など）のとき true
+    std::vector<bool> required_array_;
+
+    // frontier_index_array_[v]: v のフロンティア上の添え字（フロンティア上にないときは -1）
+    std::vector<int> frontier_index_array_;
+    // フロンティア上にない頂点の union-find 用配列
+    std::vector<int> vertex_parent_array_;
+    // vertex_comp_array_[v]: フロンティア上にない頂点 v が属する連結成分の番号
+    std::vector<int> vertex_comp_array_;
+    // root_comp_array_[r]: union-find の根 r に対応する連結成分の番号
+    std::vector<int> root_comp_array_;
+
+    // frontier_adj_array_[i]: フロンティア上の i 番目の頂点と未処理の辺で結ばれた
+    // フロンティア上の頂点の添え字の配列
+    std::vector<std::vector<int> > frontier_adj_array_;
+    // comp_adj_array_[i]: フロンティア上の i 番目の頂点と未処理の辺で結ばれた連結成分の番号の配列
+    std::vector<std::vector<int> > comp_adj_array_;
+    // comp_required_array_[c]: 連結成分 c に含まれる、端点として扱う頂点の数
+    std::vector<int> comp_required_array_;
+    // comp_touched_array_[c]: 連結成分 c がフロンティアと隣接しているとき true
+    std::vector<bool> comp_touched_array_;
+
+    // フロンティアと隣接しない連結成分の中に端点の数が奇数のものが存在するとき true
+    bool is_untouched_odd_;
+    // フロンティアと隣接しない連結成分の中に端点の数が 2 未満のものが存在するとき true
+    bool is_untouched_uncoverable_;
+
+    // 各ノードの判定で用いる作業用配列
+    std::vector<int> parent_array_;
+    std::vector<int> count_array_;
+    std::vector<bool> cover_array_;
+
+public:
+    RestGraphManager(const Graph* graph) : graph_(graph),
+                                           required_array_(graph->GetNumberOfVertices() + 1, false),
+                                           frontier_index_array_(graph->GetNumberOfVertices() + 1, -1),
+                                           vertex_parent_array_(graph->GetNumberOfVertices() + 1),
+                                           vertex_comp_array_(graph->GetNumberOfVertices() + 1, -1),
+                                           root_comp_array_(graph->GetNumberOfVertices() + 1, -1),
+                                           is_untouched_odd_(false),
+                                           is_untouched_uncoverable_(false) { }
+
+    void SetRequired(int v)
+    {
+        required_array_[v] = true;
+    }
+
+    // current_edge_num 番目の辺を処理した直後の残りグラフについて前計算を行う。
+    // frontier_manager は current_edge_num 番目の辺について Update 済みでなければならない。
+    // 1 回の呼び出しで残りの辺をすべて走査するので、全体で O(辺数^2) の時間がかかる。
+    void Update(int current_edge_num, const FrontierManager& frontier_manager)
+    {
+        int number_of_edges = graph_->GetNumberOfEdges();
+        int frontier_size = frontier_manager.GetNextFrontierSize();
+
+        for (int i = 0; i < frontier_manager.GetPreviousFrontierSize(); ++i) {
+            frontier_index_array_[frontier_manager.GetPreviousFrontierValue(i)] = -1;
+        }
+        for (int i = 0; i < frontier_size; ++i) {
+            frontier_index_array_[frontier_manager.GetNextFrontierValue(i)] = i;
+        }
+
+        // フロンティア上にない頂点同士を結ぶ未処理の辺で連結成分を求める
+        for (int i = current_edge_num + 1; i < number_of_edges; ++i) {
+            const Edge& edge = graph_->GetEdge(i);
+            vertex_parent_array_[edge.src] = edge.src;
+            vertex_parent_array_[edge.dest] = edge.dest;
+            vertex_comp_array_[edge.src] = -1;
+            vertex_comp_array_[edge.dest] = -1;
+            root_comp_array_[edge.src] = -1;
+            root_comp_array_[edge.dest] = -1;
+        }
+        for (int i = current_edge_num + 1; i < number_of_edges; ++i) {
+            const Edge& edge = graph_->GetEdge(i);
+            if (frontier_index_array_[edge.src] < 0 && frontier_index_array_[edge.dest] < 0) {
+                int x = FindVertex(edge.src);
+                int y = FindVertex(edge.dest);
+                if (x != y) {
+                    vertex_parent_array_[x] = y;
+                }
+            }
+        }
+
+        comp_required_array_.clear();
+        comp_touched_array_.clear();
+        for (int i = current_edge_num + 1; i < number_of_edges; ++i) {
+            const Edge& edge = graph_->GetEdge(i);
+            AssignComp(edge.src);
+            AssignComp(edge.dest);
+        }
+
+        frontier_adj_array_.assign(frontier_size, std::vector<int>());
+        comp_adj_array_.assign(frontier_size, std::vector<int>());
+        for (int i = current_edge_num + 1; i < number_of_edges; ++i) {
+            const Edge& edge = graph_->GetEdge(i);
+            int si = frontier_index_array_[edge.src];
+            int di = frontier_index_array_[edge.dest];
+            if (si >= 0 && di >= 0) {
+                frontier_adj_array_[si].push_back(di);
+                frontier_adj_array_[di].push_back(si);
+            } else if (si >= 0) {
+                comp_adj_array_[si].push_back(vertex_comp_array_[edge.dest]);
+                comp_touched_array_[vertex_comp_array_[edge.dest]] = true;
+            } else if (di >= 0) {
+                comp_adj_array_[di].push_back(vertex_comp_array_[edge.src]);
+                comp_touched_array_[vertex_comp_array_[edge.src]] = true;
+            }
+        }
+
+        is_untouched_odd_ = false;
+        is_untouched_uncoverable_ = false;
+        for (uint c = 0; c < comp_required_array_.size(); ++c) {
+            if (!comp_touched_array_[c]) {
+                if (comp_required_array_[c] % 2 != 0) {
+                    is_untouched_odd_ = true;
+                }
+                if (comp_required_array_[c] < 2) {
+                    is_untouched_uncoverable_ = true;
+                }
+            }
+        }
+
+        int size = frontier_size + static_cast<int>(comp_required_array_.size());
+        parent_array_.resize(size);
+        count_array_.resize(size);
+        cover_array_.resize(size);
+    }
+
+    // 各頂点が必要な本数の辺を残りグラフから接続できるか判定する。
+    // kind_array[i] はフロンティア上の i 番目の頂点の種類。
+    // isolated_degree は ISOLATED の頂点に接続しなければならない辺の本数。
+    bool CheckDegree(const std::vector<int>& kind_array, int isolated_degree) const
+    {
+        for (uint i = 0; i < kind_array.size(); ++i) {
+            if (kind_array[i] == SATURATED) {
+                continue;
+            }
+            int required_degree = (kind_array[i] == ENDPOINT ? 1 : isolated_degree);
+            int degree = static_cast<int>(comp_adj_array_[i].size());
+            for (uint j = 0; j < frontier_adj_array_[i].size() && degree < required_degree; ++j) {
+                if (kind_array[frontier_adj_array_[i][j]] != SATURATED) {
+                    ++degree;
+                }
+            }
+            if (degree < required_degree) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 端点どうしを残りグラフのパスで対にできるか判定する。
+    // 残りグラフの各連結成分に含まれる端点の数は偶数でなければならない。
+    // is_covering が true の場合、まだ辺が接続されていない頂点をすべて覆う必要がある。
+    // is_cycle が true の場合、端点が1つもなければ新たにサイクルを作ることができるとみなす。
+    bool CheckPairing(const std::vector<int>& kind_array, bool is_covering, bool is_cycle)
+    {
+        int frontier_size = static_cast<int>(kind_array.size());
+        int size = static_cast<int>(parent_array_.size());
+        int number_of_endpoints = 0;
+
+        for (int i = 0; i < size; ++i) {
+            parent_array_[i] = i;
+            if (i < frontier_size) {
+                count_array_[i] = (kind_array[i] == ENDPOINT ? 1 : 0);
+                cover_array_[i] = (kind_array[i] == ISOLATED);
+            } else {
+                count_array_[i] = comp_required_array_[i - frontier_size];
+                cover_array_[i] = comp_touched_array_[i - frontier_size];
+            }
+            number_of_endpoints += count_array_[i];
+        }
+        if (is_cycle && number_of_endpoints == 0) {
+            return true;
+        }
+        if (is_untouched_odd_ || (is_covering && is_untouched_uncoverable_)) {
+            return false;
+        }
+
+        for (int i = 0; i < frontier_size; ++i) {
+            if (kind_array[i] == SATURATED) {
+                continue;
+            }
+            for (uint j = 0; j < frontier_adj_array_[i].size(); ++j) {
+                if (kind_array[frontier_adj_array_[i][j]] != SATURATED) {
+                    Union(i, frontier_adj_array_[i][j]);
+                }
+            }
+            for (uint j = 0; j < comp_adj_array_[i].size(); ++j) {
+                Union(i, frontier_size + comp_adj_array_[i][j]);
+            }
+        }
+
+        for (int i = 0; i < size; ++i) {
+            if (parent_array_[i] == i) {
+                if (count_array_[i] % 2 != 0) {
+                    return false;
+                }
+                if (is_covering && cover_array_[i] && count_array_[i] < 2) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+private:
+    int FindVertex(int v)
+    {
+        while (vertex_parent_array_[v] != v) {
+            vertex_parent_array_[v] = vertex_parent_array_[vertex_parent_array_[v]];
+            v = vertex_parent_array_[v];
+        }
+        return v;
+    }
+
+    // フロンティア上にない頂点 v に連結成分の番号を割り当てる
+    void AssignComp(int v)
+    {
+        if (frontier_index_array_[v] >= 0 || vertex_comp_array_[v] >= 0) {
+            return;
+        }
+        int r = FindVertex(v);
+        if (root_comp_array_[r] < 0) {
+            root_comp_array_[r] = static_cast<int>(comp_required_array_.size());
+            comp_required_array_.push_back(0);
+            comp_touched_array_.push_back(false);
+        }
+        vertex_comp_array_[v] = root_comp_array_[r];
+        if (required_array_[v]) {
+            ++comp_required_array_[vertex_comp_array_[v]];
+        }
+    }
+
+    int Find(int x)
+    {
+        while (parent_array_[x] != x) {
+            parent_array_[x] = parent_array_[parent_array_[x]];
+            x = parent_array_[x];
+        }
+        return x;
+    }
+
+    void Union(int x, int y)
+    {
+        x = Find(x);
+        y = Find(y);
+        if (x != y) {
+            parent_array_[x] = y;
+            count_array_[y] += count_array_[x];
+            cover_array_[y] = cover_array_[y] || cover_array_[x];
+        }
+    }
+};
+
+} // the end of the namespace
+
+#endif // RESTGRAPHMANAGER_HPP
@@ -0,0 +1,383 @@
+//
+// Sampler.hpp
+//
+// Copyright (c) 2012 -- 2016 Jun Kawahara
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef SAMPLER_HPP
+#define SAMPLER_HPP
+
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "Global.hpp"
+#include "BigInteger.hpp"
+#include "SolutionArray.hpp"
+
+namespace frontier_lib {
+
+//*************************************************************************************************
+// Random64: 64 ビットの擬似乱数生成器 (xoshiro256**)。
+// 状態は seed と系列番号 stream から SplitMix64 で作るので、系列番号ごとに独立な乱数列が得られる。
+class Random64 {
+private:
+    uint64 state_[4];
+
+public:
+    Random64(uint64 seed, uint64 stream = 0)
+    {
+        uint64 x = seed ^ (stream * 0xd1342543de82ef95ull);
+        for (int i = 0; i < 4; ++i) {
+            x += 0x9e3779b97f4a7c15ull;
+            uint64 z = x;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            state_[i] = z ^ (z >> 31);
+        }
+    }
+
+    uint64 Next()
+    {
+        uint64 result = Rotate(state_[1] * 5, 7) * 9;
+        uint64 t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = Rotate(state_[3], 45);
+        return result;
+    }
+
+    // [0, 1) の一様乱数（53 ビット精度）
+    double NextDouble()
+    {
+        return static_cast<double>(Next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // [0, n) の一様乱数 (n > 0)。n 以上の値は棄却するので偏りはない。
+    uint64 Below(uint64 n)
+    {
+        uint64 mask = GetMask(n - 1);
+        uint64 r;
+        do {
+            r = Next() & mask;
+        } while (r >= n);
+        return r;
+    }
+
+    // n - 1 以下の値を全て表せる最小の 2^k - 1
+    static uint64 GetMask(uint64 n)
+    {
+        uint64 mask = n;
+        for (int k = 1; k < 64; k <<= 1) {
+            mask |= (mask >> k);
+        }
+        return mask;
+    }
+
+private:
+    static uint64 Rotate(uint64 x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+};
+
+// [0, n) の一様乱数 (n > 0)
+inline uintx RandomBelow(uintx n, Random64* random)
+{
+    return random->Below(n);
+}
+
+inline BigInteger RandomBelow(const BigInteger& n, Random64* random)
+{
+    int k = n.GetNumberOfPlaces();
+    while (k > 1 && n.GetPlace(k - 1) == 0) {
+        --k;
+    }
+    uint64 mask = Random64::GetMask(n.GetPlace(k - 1));
+    BigInteger r;
+    do {
+        for (int i = 0; i < k - 1; ++i) {
+            r.Set(i, random->Next());
+        }
+        r.Set(k - 1, random->Next() & mask);
+    } while (!(r < n));
+    return r;
+}
+
+// *a += b を計算し、overflow したら true を返す
+inline bool AddWithOverflowCheck(uintx* a, uintx b)
+{
+    *a += b;
+    return *a < b;
+}
+
+inline bool AddWithOverflowCheck(BigInteger* a, const BigInteger& b)
+{
+    *a += b;
+    return false;
+}
+
+// 非負整数 n の 10 進表記を buffer の末尾に追加する
+inline void AppendNumber(int n, std::string* buffer)
+{
+    char digits[16];
+    int length = 0;
+    do {
+        digits[length] = static_cast<char>('0' + n % 10);
+        ++length;
+        n /= 10;
+    } while (n > 0);
+    while (length > 0) {
+        --length;
+        *buffer += digits[length];
+    }
+}
+
+// sampler から sample_num 個の解を取り出して 1 行に 1 つずつ fp に出力する。
+// Sampler は HasSolution() と Sample(Random64*, std::vector<int>*) を持つクラスである。
+// i 番目のサンプルは Random64(seed, i) で生成するので、出力はスレッド数によらない。
+// サンプルは BATCH_SIZE 個ずつ（OpenMP が有効な場合は並列に）生成し、まとめて書き出す。
+template <typename Sampler>
+void OutputSampleBatches(const Sampler& sampler, FILE* fp, int sample_num, uint64 seed)
+{
+    enum {BATCH_SIZE = 4096}; // 1 度に生成して出力するサンプル数
+    enum {BUFFER_SIZE = 1 << 16}; // 出力バッファがこのバイト数を超えたら書き出す
+
+    if (!sampler.HasSolution()) {
+        return;
+    }
+
+    std::vector<std::vector<int> > batch(BATCH_SIZE);
+    std::string buffer;
+    buffer.reserve(BUFFER_SIZE + 1024);
+
+    for (int first = 0; first < sample_num; first += BATCH_SIZE) {
+        int count = std::min(static_cast<int>(BATCH_SIZE), sample_num - first);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (int k = 0; k < count; ++k) {
+            Random64 random(seed, static_cast<uint64>(first + k));
+            sampler.Sample(&random, &batch[k]);
+        }
+        for (int k = 0; k < count; ++k) {
+            for (uint j = 0; j < batch[k].size(); ++j) {
+                if (j > 0) {
+                    buffer += ' ';
+                }
+                AppendNumber(batch[k][j], &buffer);
+            }
+            buffer += '\n';
+            if (buffer.size() >= BUFFER_SIZE) {
+                fwrite(buffer.data(), 1, buffer.size(), fp);
+                buffer.clear();
+            }
+        }
+    }
+    fwrite(buffer.data(), 1, buffer.size(), fp);
+}
+
+//*************************************************************************************************
+// UniformSampler<T>: ZDD の表す集合族から、解を一様ランダムに取り出すクラス。
+// 各ノードから 1 終端への経路数を T 型で正確に数えておき、[0, 解の数) の一様乱数 r を 1 つ
+// 引いて、r 番目の経路を根からたどる（r が lo 子の経路数未満なら lo 子へ、そうでなければ
+// r から lo 子の経路数を引いて hi 子へ進む）。浮動小数点数を用いないので、解の数が
+// 大きくても偏りは生じない。T は uintx か BigInteger であり、uintx で数えたときに overflow
+// した場合は IsOverflow() が true を返す。
+template <typename T>
+class UniformSampler {
+private:
+    const std::vector<std::pair<intx, intx> >& node_array_;
+    std::vector<T> count_array_; // count_array_[id]: ノード id から 1 終端への経路数
+    std::vector<int> level_array_; // level_array_[id]: ノード id のレベル
+    bool is_overflow_;
+
+public:
+    UniformSampler(const std::vector<std::pair<intx, intx> >& node_array,
+                   const std::vector<intx>& level_first_array)
+        : node_array_(node_array), is_overflow_(false)
+    {
+        MakeNodeLevelArray(node_array_, level_first_array, &level_array_);
+
+        count_array_.resize(node_array_.size());
+        if (node_array_.size() >= 2) {
+            count_array_[0] = 0;
+            count_array_[1] = 1;
+        }
+        for (intx j = static_cast<intx>(node_array_.size()) - 1; j >= 2; --j) {
+            count_array_[j] = count_array_[node_array_[j].first];
+            if (AddWithOverflowCheck(&count_array_[j], count_array_[node_array_[j].second])) {
+                is_overflow_ = true;
+                return;
+            }
+        }
+    }
+
+    bool IsOverflow() const
+    {
+        return is_overflow_;
+    }
+
+    bool HasSolution() const
+    {
+        return node_array_.size() > 2 && !(count_array_[2] == T());
+    }
+
+    // 解を 1 つ取り出し、含まれる変数の番号（1 から始まる）を (*result) に格納する。
+    // 解が存在しない場合は false を返す。
+    bool Sample(Random64* random, std::vector<int>* result) const
+    {
+        result->clear();
+        if (!HasSolution()) {
+            return false;
+        }
+        T r = RandomBelow(count_array_[2], random);
+        intx id = 2;
+        while (id >= 2) {
+            const T& lo_count = count_array_[node_array_[id].first];
+            if (r < lo_count) {
+                id = node_array_[id].first;
+            } else {
+                r -= lo_count;
+                result->push_back(level_array_[id] + 1);
+                id = node_array_[id].second;
+            }
+        }
+        return true;
+    }
+
+    // sample_num 個の解を取り出して 1 行に 1 つずつ fp に出力する
+    void OutputSamples(FILE* fp, int sample_num, uint64 seed) const
+    {
+        OutputSampleBatches(*this, fp, sample_num, seed);
+    }
+};
+
+//*************************************************************************************************
+// BoltzmannSampler: 各変数 i に重み exp(log_weight_array[i]) を与え、解を、含まれる変数の
+// 重みの積に比例する確率で取り出すクラス。例えば log_weight_array[i] = -beta * w_i とすると、
+// 解 X は exp(-beta * (X の重みの和)) に比例する確率で選ばれる。
+// 各ノードから 1 終端への経路の重みの和（分配関数）を対数で保持するので、overflow や
+// underflow は起こらない。ZDD では飛ばされた変数は使われないので、重み 1 として扱ってよい。
+class BoltzmannSampler {
+private:
+    const std::vector<std::pair<intx, intx> >& node_array_;
+    std::vector<double> log_weight_array_; // log_weight_array_[i]: レベル i の変数の重みの対数
+    std::vector<double> log_z_array_; // log_z_array_[id]: ノード id の分配関数の対数
+    std::vector<int> level_array_; // level_array_[id]: ノード id のレベル
+
+public:
+    // log_weight_array の要素数がレベル数より少ない場合、残りの変数の重みは 1 とする
+    BoltzmannSampler(const std::vector<std::pair<intx, intx> >& node_array,
+                     const std::vector<intx>& level_first_array,
+                     const std::vector<double>& log_weight_array)
+        : node_array_(node_array), log_weight_array_(log_weight_array)
+    {
+        MakeNodeLevelArray(node_array_, level_first_array, &level_array_);
+        if (log_weight_array_.size() + 1 < level_first_array.size()) {
+            log_weight_array_.resize(level_first_array.size() - 1, 0.0);
+        }
+
+        log_z_array_.resize(node_array_.size());
+        if (node_array_.size() >= 2) {
+            log_z_array_[0] = -std::numeric_limits<double>::infinity();
+            log_z_array_[1] = 0.0;
+        }
+        for (intx j = static_cast<intx>(node_array_.size()) - 1; j >= 2; --j) {
+            log_z_array_[j] = LogAdd(log_z_array_[node_array_[j].first],
+                                     log_weight_array_[level_array_[j]]
+                                     + log_z_array_[node_array_[j].second]);
+        }
+    }
+
+    // 全解の重みの和の対数（解が存在しなければ -inf）
+    double GetLogPartitionFunction() const
+    {
+        if (node_array_.size() <= 2) {
+            return -std::numeric_limits<double>::infinity();
+        }
+        return log_z_array_[2];
+    }
+
+    bool HasSolution() const
+    {
+        return GetLogPartitionFunction() > -std::numeric_limits<double>::infinity();
+    }
+
+    // 解を 1 つ取り出し、含まれる変数の番号（1 から始まる）を (*result) に格納する。
+    // 各ノードで hi 子へ進む確率は（hi 側の重みの和）/（ノードの分配関数）である。
+    // 解が存在しない場合は false を返す。
+    bool Sample(Random64* random, std::vector<int>* result) const
+    {
+        result->clear();
+        if (!HasSolution()) {
+            return false;
+        }
+        intx id = 2;
+        while (id >= 2) {
+            int level = level_array_[id];
+            intx lo = node_array_[id].first;
+            intx hi = node_array_[id].second;
+            bool is_hi;
+            if (log_z_array_[lo] == -std::numeric_limits<double>::infinity()) {
+                is_hi = true; // 丸め誤差で 0 終端へ進まないようにする
+            } else if (log_z_array_[hi] == -std::numeric_limits<double>::infinity()) {
+                is_hi = false;
+            } else {
+                double hi_prob = exp(log_weight_array_[level] + log_z_array_[hi]
+                                     - log_z_array_[id]);
+                is_hi = (random->NextDouble() < hi_prob);
+            }
+            if (is_hi) {
+                result->push_back(level + 1);
+                id = hi;
+            } else {
+                id = lo;
+            }
+        }
+        return true;
+    }
+
+    // sample_num 個の解を取り出して 1 行に 1 つずつ fp に出力する
+    void OutputSamples(FILE* fp, int sample_num, uint64 seed) const
+    {
+        OutputSampleBatches(*this, fp, sample_num, seed);
+    }
+
+private:
+    // log(exp(a) + exp(b))
+    static double LogAdd(double a, double b)
+    {
+        if (a < b) {
+            std::swap(a, b);
+        }
+        if (b == -std::numeric_limits<double>::infinity()) {
+            return a;
+        }
+        return a + log1p(exp(b - a));
+    }
+};
+
+} // the end of the namespace
+
+#endif // SAMPLER_HPP
@@ -0,0 +1,204 @@
+//
+// Semiring.hpp
+//
+// Copyright (c) 2012 -- 2016 Jun Kawahara
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef SEMIRING_HPP
+#define SEMIRING_HPP
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+#include "Global.hpp"
+
+namespace frontier_lib {
+
+// 以下のクラスは、FrontierAlgorithm::Evaluate においてフロンティア法の各ノードに持たせる
+// 半環の値を定める。各クラスは次のメンバを持つ。
+//   ValueType: 値の型
+//   Zero(): 解が存在しないことを表す値（Add の単位元）
+//   One(): 根ノードに与える値
+//   Add(a, b): 等価なノードに合流したときに、値 b を *a に合わせる
+//   Extend(value, edge, child_num): 辺 edge を使わない (child_num == 0) または使う
+//                                   (child_num == 1) ときに子ノードに渡す値
+//   ExtendToEnd(value, edge): 辺 edge の処理で1終端に到達したとき、
+//                             それより後の辺をすべて使わないとして 1終端に渡す値
+
+//*************************************************************************************************
+// CountingSemiring: 解の個数を数える
+template <typename T>
+class CountingSemiring {
+public:
+    typedef T ValueType;
+
+    T Zero() const
+    {
+        T value;
+        value = 0;
+        return value;
+    }
+
+    T One() const
+    {
+        T value;
+        value = 1;
+        return value;
+    }
+
+    void Add(T* a, const T& b) const
+    {
+        *a += b;
+    }
+
+    const T& Extend(const T& value, int /*edge*/, int /*child_num*/) const
+    {
+        return value;
+    }
+
+    const T& ExtendToEnd(const T& value, int /*edge*/) const
+    {
+        return value;
+    }
+};
+
+//*************************************************************************************************
+// MinPlusSemiring: 解に含まれる辺の重みの総和の最小値を求める
+class MinPlusSemiring {
+private:
+    std::vector<double> weight_array_; // weight_array_[i]: 辺 i の重み
+
+public:
+    typedef double ValueType;
+
+    MinPlusSemiring(const std::vector<double>& weight_array) : weight_array_(weight_array) { }
+
+    double Zero() const
+    {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    double One() const
+    {
+        return 0.0;
+    }
+
+    void Add(double* a, double b) const
+    {
+        *a = std::min(*a, b);
+    }
+
+    double Extend(double value, int edge, int child_num) const
+    {
+        return (child_num == 1 ? value + weight_array_[edge] : value);
+    }
+
+    double ExtendToEnd(double value, int /*edge*/) const
+    {
+        return value;
+    }
+};
+
+//*************************************************************************************************
+// MaxPlusSemiring: 解に含まれる辺の重みの総和の最大値を求める
+class MaxPlusSemiring {
+private:
+    std::vector<double> weight_array_; // weight_array_[i]: 辺 i の重み
+
+public:
+    typedef double ValueType;
+
+    MaxPlusSemiring(const std::vector<double>& weight_array) : weight_array_(weight_array) { }
+
+    double Zero() const
+    {
+        return -std::numeric_limits<double>::infinity();
+    }
+
+    double One() const
+    {
+        return 0.0;
+    }
+
+    void Add(double* a, double b) const
+    {
+        *a = std::max(*a, b);
+    }
+
+    double Extend(double value, int edge, int child_num) const
+    {
+        return (child_num == 1 ? value + weight_array_[edge] : value);
+    }
+
+    double ExtendToEnd(double value, int /*edge*/) const
+    {
+        return value;
+    }
+};
+
+//*************************************************************************************************
+// ProbabilitySemiring: 各辺が独立に確率 p_i で使われるとき、使われる辺の集合が解となる確率を求める
+class ProbabilitySemiring {
+private:
+    std::vector<double> probability_array_; // probability_array_[i]: 辺 i が使われる確率
+    // rest_array_[i]: 辺 i より後の辺がすべて使われない確率
+    std::vector<double> rest_array_;
+
+public:
+    typedef double ValueType;
+
+    ProbabilitySemiring(const std::vector<double>& probability_array)
+        : probability_array_(probability_array)
+    {
+        int n = static_cast<int>(probability_array_.size());
+        rest_array_.resize(n);
+        for (int i = n - 1; i >= 0; --i) {
+            rest_array_[i] = (i == n - 1 ? 1.0 : rest_array_[i + 1] * (1.0 - probability_array_[i + 1]));
+        }
+    }
+
+    double Zero() const
+    {
+        return 0.0;
+    }
+
+    double One() const
+    {
+        return 1.0;
+    }
+
+    void Add(double* a, double b) const
+    {
+        *a += b;
+    }
+
+    double Extend(double value, int edge, int child_num) const
+    {
+        return value * (child_num == 1 ? probability_array_[edge]
+                        : 1.0 - probability_array_[edge]);
+    }
+
+    double ExtendToEnd(double value, int edge) const
+    {
+        return value * rest_array_[edge];
+    }
+};
+
+} // the end of the namespace
+
+#endif // SEMIRING_HPP
@@ -28,6 +28,11 @@
 #include <iostream>
 #include <vector>
 #include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+
+#include "BigInteger.hpp"
 
 namespace frontier_lib {
 
@@ -53,6 +58,20 @@ inline double Divide<MpInt>(MpInt nume, MpInt deno)
 }
 #endif
 
+// ZDD の各ノードのレベル（0 から始まる）を (*level_array) に格納する。
+// 終端ノードのレベルは 0 とするので、必要なら呼び出し側で設定し直すこと。
+inline void MakeNodeLevelArray(const std::vector<std::pair<intx, intx> >& node_array,
+                               const std::vector<intx>& level_first_array,
+                               std::vector<int>* level_array)
+{
+    level_array->assign(node_array.size(), 0);
+    for (uint i = 0; i + 1 < level_first_array.size(); ++i) {
+        for (intx j = level_first_array[i]; j < level_first_array[i + 1]; ++j) {
+            (*level_array)[j] = i;
+        }
+    }
+}
+
 //*************************************************************************************************
 // SolutionArray: 解の数を数えるためのインターフェースクラス。
 class SolutionArray {
@@ -69,39 +88,64 @@ public:
 template <typename T>
 class SolutionArrayDerive : public SolutionArray {
 private:
+    enum {CHUNK_SIZE = 1024}; // 並列計算で 1 度にスレッドに割り当てるノード数
+
     std::vector<T> solution_array_;
 public:
     virtual ~SolutionArrayDerive() {}
 
     // 解の数の計算を行う。overflow チェックは行わない。
-    T ComputeNumberOfSolutions(const std::vector<std::pair<intx, intx> >& node_array)
+    // 同じレベルのノードは下のレベルのノードにのみ依存するので、
+    // OpenMP が有効な場合はレベルごとにノードを分割して並列に計算する。
+    T ComputeNumberOfSolutions(const std::vector<std::pair<intx, intx> >& node_array,
+                               const std::vector<intx>& level_first_array)
     {
         solution_array_.resize(node_array.size());
         solution_array_[0] = 0;
         solution_array_[1] = 1;
 
-        for (intx i = static_cast<intx>(node_array.size()) - 1; i >= 2; --i) {
-            solution_array_[i] = solution_array_[node_array[i].first]
-                                  + solution_array_[node_array[i].second];
+        for (int i = static_cast<int>(level_first_array.size()) - 2; i >= 0; --i) {
+            intx first = level_first_array[i];
+            intx last = level_first_array[i + 1];
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, CHUNK_SIZE) if (last - first >= 2 * CHUNK_SIZE)
+#endif
+            for (intx j = first; j < last; ++j) {
+                solution_array_[j] = solution_array_[node_array[j].first]
+                                      + solution_array_[node_array[j].second];
+            }
         }
 
         return solution_array_[2];
     }
 
     // 解の数の計算を行う。計算時に overflow チェックを行う。uintx 型限定
-    uintx ComputeNumberOfSolutionsOF(const std::vector<std::pair<intx, intx> >& node_array)
+    uintx ComputeNumberOfSolutionsOF(const std::vector<std::pair<intx, intx> >& node_array,
+                                     const std::vector<intx>& level_first_array)
     {
         solution_array_.resize(node_array.size());
         solution_array_[0] = 0;
         solution_array_[1] = 1;
 
-        for (intx i = static_cast<intx>(node_array.size()) - 1; i >= 2; --i) {
-            if (solution_array_[node_array[i].second] > UINTX_MAX
-                                    - solution_array_[node_array[i].first]) { // overflow
+        for (int i = static_cast<int>(level_first_array.size()) - 2; i >= 0; --i) {
+            intx first = level_first_array[i];
+            intx last = level_first_array[i + 1];
+            bool is_overflow = false; // 並列領域からは例外を投げられないので、フラグで伝える
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, CHUNK_SIZE) if (last - first >= 2 * CHUNK_SIZE) \
+    reduction(||:is_overflow)
+#endif
+            for (intx j = first; j < last; ++j) {
+                if (solution_array_[node_array[j].second] > UINTX_MAX
+                                        - solution_array_[node_array[j].first]) { // overflow
+                    is_overflow = true;
+                }
+                solution_array_[j] = solution_array_[node_array[j].first]
+                                      + solution_array_[node_array[j].second];
+            }
+            if (is_overflow) {
                 throw std::overflow_error("overflow!");
             }
-            solution_array_[i] = solution_array_[node_array[i].first]
-                                  + solution_array_[node_array[i].second];
         }
 
         return solution_array_[2];
@@ -131,13 +175,10 @@ public:
                 }
             }
             if (is_hi) {
-                for (uint i = 0; i < level_first_array.size(); ++i) {
-                    if (level_first_array[i] <= current_node
-                        && current_node < level_first_array[i + 1]) {
-                        result->push_back(i + 1);
-                        break;
-                    }
-                }
+                result->push_back(static_cast<int>(std::upper_bound(level_first_array.begin(),
+                                                                    level_first_array.end(),
+                                                                    current_node)
+                                                   - level_first_array.begin()));
                 current_node = node_array[current_node].second;
             } else {
                 current_node = node_array[current_node].first;
@@ -146,60 +187,815 @@ public:
     }
 };
 
+//*************************************************************************************************
+// ModularCounter: 解の数を、2^61 より大きい複数の素数を法として数え、
+// 中国剰余定理によって復元するクラス。
+// 解の数は 2^(変数の数) 未満なので、法の積がそれを超えるだけの素数を用いる。
+// 各ノードの値は素数の個数分だけ連続して並べ、素数についての内側のループがベクトル化されるようにする。
+// 加算のみを行うので、素数が 2^62 未満であれば途中で 64 ビットを溢れることはない。
+class ModularCounter {
+private:
+    std::vector<uint64> prime_array_;
+
+public:
+    ModularCounter(int number_of_variables)
+    {
+        int number_of_primes = number_of_variables / 61 + 1;
+        for (uint64 p = (1ull << 62) - 1; static_cast<int>(prime_array_.size()) < number_of_primes;
+             p -= 2) {
+            if (IsPrime(p)) {
+                prime_array_.push_back(p);
+            }
+        }
+    }
+
+    BigInteger ComputeNumberOfSolutions(const std::vector<std::pair<intx, intx> >& node_array) const
+    {
+        const intx k = prime_array_.size();
+        const uint64* prime = &prime_array_[0];
+        std::vector<uint64> value_array(node_array.size() * k);
+        for (intx j = 0; j < k; ++j) {
+            value_array[j] = 0; // 0-terminal
+            value_array[k + j] = 1; // 1-terminal
+        }
+
+        for (intx i = static_cast<intx>(node_array.size()) - 1; i >= 2; --i) {
+            uint64* value = &value_array[i * k];
+            const uint64* lo = &value_array[node_array[i].first * k];
+            const uint64* hi = &value_array[node_array[i].second * k];
+            for (intx j = 0; j < k; ++j) {
+                uint64 sum = lo[j] + hi[j];
+                value[j] = (sum >= prime[j] ? sum - prime[j] : sum);
+            }
+        }
+
+        if (node_array.size() <= 2) {
+            return BigInteger();
+        }
+        return Reconstruct(&value_array[2 * k]);
+    }
+
+private:
+    // 剰余 residue_array[i] (mod prime_array_[i]) を満たす最小の非負整数を返す（Garner のアルゴリズム）
+    BigInteger Reconstruct(const uint64* residue_array) const
+    {
+        int k = static_cast<int>(prime_array_.size());
+        // 解を x = c[0] + p[0] * (c[1] + p[1] * (c[2] + ...)) と表したときの c[i]
+        std::vector<uint64> coef_array(k);
+        for (int i = 0; i < k; ++i) {
+            uint64 p = prime_array_[i];
+            // c[0] + p[0] * c[1] + ... + p[0] ... p[i - 2] * c[i - 1] を p で割った余り
+            uint64 x = 0;
+            uint64 product = 1;
+            for (int j = 0; j < i; ++j) {
+                x = AddMod(x, MulMod(coef_array[j] % p, product, p), p);
+                product = MulMod(product, prime_array_[j] % p, p);
+            }
+            uint64 diff = (residue_array[i] >= x ? residue_array[i] - x : residue_array[i] + p - x);
+            coef_array[i] = MulMod(diff, PowMod(product, p - 2, p), p);
+        }
+
+        BigInteger result;
+        result = coef_array[k - 1];
+        for (int i = k - 2; i >= 0; --i) {
+            result.MultiplyAndAdd(prime_array_[i], coef_array[i]);
+        }
+        return result;
+    }
+
+    // a, b < m < 2^62 を仮定する
+    static uint64 AddMod(uint64 a, uint64 b, uint64 m)
+    {
+        uint64 sum = a + b;
+        return (sum >= m ? sum - m : sum);
+    }
+
+    static uint64 MulMod(uint64 a, uint64 b, uint64 m)
+    {
+        uint64 hi, lo;
+        BigInteger::Multiply64(a, b, &hi, &lo);
+        // (hi * 2^64 + lo) mod m をビットごとに計算する
+        uint64 r = hi % m;
+        for (int i = 63; i >= 0; --i) {
+            r = AddMod(r, r, m);
+            if ((lo >> i) & 1) {
+                r = AddMod(r, 1, m);
+            }
+        }
+        return r;
+    }
+
+    static uint64 PowMod(uint64 a, uint64 e, uint64 m)
+    {
+        uint64 r = 1 % m;
+        while (e > 0) {
+            if (e & 1) {
+                r = MulMod(r, a, m);
+            }
+            a = MulMod(a, a, m);
+            e >>= 1;
+        }
+        return r;
+    }
+
+    // Miller-Rabin 法（2^64 未満では以下の底で決定的に判定できる）
+    static bool IsPrime(uint64 n)
+    {
+        const uint64 bases[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+        uint64 d = n - 1;
+        int s = 0;
+        while ((d & 1) == 0) {
+            d >>= 1;
+            ++s;
+        }
+        for (int i = 0; i < 12; ++i) {
+            uint64 x = PowMod(bases[i] % n, d, n);
+            if (x == 0 || x == 1 || x == n - 1) {
+                continue;
+            }
+            bool is_composite = true;
+            for (int j = 1; j < s; ++j) {
+                x = MulMod(x, x, n);
+                if (x == n - 1) {
+                    is_composite = false;
+                    break;
+                }
+            }
+            if (is_composite) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+//*************************************************************************************************
+// AdaptiveCounter: 解の数を、レベルごとに必要な桁数を選びながら数えるクラス。
+// 各レベルのノードの値は、そのレベルで共通の個数 (width) の 64 ビットの limb で表し、
+// レベルごとの連続した配列に格納する（ノードごとのメモリ確保は行わない）。
+// width が 1 のときは uint64、2 のときは 128 ビット整数として加算し、それ以上は limb ごとに加算する。
+// あるレベルの width は子のレベルの width の最大値とし、桁あふれが起きた場合は
+// そのレベルのみ width を 1 増やして計算し直す。
+class AdaptiveCounter {
+private:
+    const std::vector<std::pair<intx, intx> >& node_array_;
+    const std::vector<intx>& level_first_array_;
+    std::vector<std::vector<uint64> > value_array_; // value_array_[i]: レベル i のノードの値
+    std::vector<int> width_array_; // width_array_[i]: レベル i の値の limb 数
+    std::vector<int> level_array_; // level_array_[id]: ノード id のレベル
+    uint64 terminal_array_[2];
+
+public:
+    AdaptiveCounter(const std::vector<std::pair<intx, intx> >& node_array,
+                    const std::vector<intx>& level_first_array)
+        : node_array_(node_array), level_first_array_(level_first_array)
+    {
+        MakeNodeLevelArray(node_array_, level_first_array_, &level_array_);
+        terminal_array_[0] = 0;
+        terminal_array_[1] = 1;
+    }
+
+    BigInteger ComputeNumberOfSolutions()
+    {
+        int number_of_levels = static_cast<int>(level_first_array_.size()) - 1;
+        value_array_.resize(number_of_levels);
+        width_array_.resize(number_of_levels);
+
+        for (int i = number_of_levels - 1; i >= 0; --i) {
+            int width = 1;
+            for (intx j = level_first_array_[i]; j < level_first_array_[i + 1]; ++j) {
+                width = std::max(width, std::max(GetWidth(node_array_[j].first),
+                                                 GetWidth(node_array_[j].second)));
+            }
+            while (!ComputeLevel(i, width)) { // 桁あふれした場合は 1 limb 増やす
+                ++width;
+            }
+        }
+
+        BigInteger result;
+        if (node_array_.size() <= 2) {
+            return result;
+        }
+        const uint64* value = GetValue(2);
+        for (int k = 0; k < GetWidth(2); ++k) {
+            result.Set(k, value[k]);
+        }
+        return result;
+    }
+
+private:
+    int GetWidth(intx id) const
+    {
+        return (id < 2 ? 1 : width_array_[level_array_[id]]);
+    }
+
+    const uint64* GetValue(intx id) const
+    {
+        if (id < 2) {
+            return &terminal_array_[id];
+        }
+        int level = level_array_[id];
+        return &value_array_[level][(id - level_first_array_[level]) * width_array_[level]];
+    }
+
+    // レベル level のノードの値を width 個の limb で計算する。桁あふれした場合は false を返す。
+    bool ComputeLevel(int level, int width)
+    {
+        intx first = level_first_array_[level];
+        intx last = level_first_array_[level + 1];
+        std::vector<uint64>& values = value_array_[level];
+        values.assign((last - first) * width, 0);
+        width_array_[level] = width;
+
+        for (intx j = first; j < last; ++j) {
+            intx lo_id = node_array_[j].first;
+            intx hi_id = node_array_[j].second;
+            const uint64* lo = GetValue(lo_id);
+            const uint64* hi = GetValue(hi_id);
+            uint64* value = &values[(j - first) * width];
+            if (width == 1) {
+                value[0] = lo[0] + hi[0];
+                if (value[0] < lo[0]) {
+                    return false;
+                }
+#ifdef __SIZEOF_INT128__
+            } else if (width == 2) {
+                unsigned __int128 a = Load128(lo, GetWidth(lo_id));
+                unsigned __int128 sum = a + Load128(hi, GetWidth(hi_id));
+                if (sum < a) {
+                    return false;
+                }
+                value[0] = static_cast<uint64>(sum);
+                value[1] = static_cast<uint64>(sum >> 64);
+#endif
+            } else {
+                int lo_width = GetWidth(lo_id);
+                int hi_width = GetWidth(hi_id);
+                uint64 c = 0;
+                for (int k = 0; k < width; ++k) {
+                    uint64 a = (k < lo_width ? lo[k] : 0);
+                    uint64 b = (k < hi_width ? hi[k] : 0);
+                    uint64 sum = a + b;
+                    uint64 c2 = (sum < a ? 1 : 0);
+                    value[k] = sum + c;
+                    c = c2 + (value[k] < sum ? 1 : 0);
+                }
+                if (c > 0) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+#ifdef __SIZEOF_INT128__
+    static unsigned __int128 Load128(const uint64* value, int width)
+    {
+        unsigned __int128 v = value[0];
+        if (width >= 2) {
+            v |= static_cast<unsigned __int128>(value[1]) << 64;
+        }
+        return v;
+    }
+#endif
+};
+
+//*************************************************************************************************
+// GeneratingFunctionCalculator<T>: 各ノードについて、解を重みの総和で分類した母関数
+// （x^k の係数が重みの総和 k の解の個数である多項式）を下のレベルから計算するクラス。
+// レベル i のノードの多項式の次数はレベル i 以降の重みの総和以下なので、その長さの係数列を
+// レベルごとの連続した配列に格納する。
+// 重みをすべて 1 にすれば、解を要素数で分類した母関数が得られる。
+template <typename T>
+class GeneratingFunctionCalculator {
+private:
+    const std::vector<std::pair<intx, intx> >& node_array_;
+    const std::vector<intx>& level_first_array_;
+    std::vector<std::vector<T> > coef_array_; // coef_array_[i]: レベル i のノードの係数列
+    std::vector<int> degree_array_; // degree_array_[i]: レベル i のノードの多項式の次数の上限
+    std::vector<int> level_array_; // level_array_[id]: ノード id のレベル
+    T terminal_array_[2];
+
+public:
+    GeneratingFunctionCalculator(const std::vector<std::pair<intx, intx> >& node_array,
+                                 const std::vector<intx>& level_first_array)
+        : node_array_(node_array), level_first_array_(level_first_array)
+    {
+        MakeNodeLevelArray(node_array_, level_first_array_, &level_array_);
+        terminal_array_[0] = 0;
+        terminal_array_[1] = 1;
+    }
+
+    // weight_array[i]: レベル i の変数の重み（非負整数）。
+    // 根の多項式の係数を (*result)[k] (k = 0, 1, ...) に格納する。
+    // レベル k の係数列は、レベル k のノードを子に持つ最も上のレベルを計算し終えた時点で
+    // 解放する。それでも同時に保持する係数の個数は、処理中のレベルをまたぐ枝の子の
+    // ノード数と重みの総和の積程度になる。
+    void Compute(const std::vector<int>& weight_array, std::vector<T>* result)
+    {
+        int number_of_levels = static_cast<int>(level_first_array_.size()) - 1;
+        coef_array_.resize(number_of_levels);
+        degree_array_.assign(number_of_levels + 1, 0);
+        for (int i = number_of_levels - 1; i >= 0; --i) {
+            degree_array_[i] = degree_array_[i + 1]
+                + (i < static_cast<int>(weight_array.size()) ? weight_array[i] : 0);
+        }
+
+        // release_array[i]: レベル i を計算し終えたら解放してよいレベルのリスト
+        std::vector<int> top_parent_array(number_of_levels, -1);
+        for (int i = number_of_levels - 1; i >= 0; --i) {
+            for (intx j = level_first_array_[i]; j < level_first_array_[i + 1]; ++j) {
+                intx child_array[2] = {node_array_[j].first, node_array_[j].second};
+                for (int c = 0; c < 2; ++c) {
+                    if (child_array[c] >= 2) {
+                        top_parent_array[level_array_[child_array[c]]] = i;
+                    }
+                }
+            }
+        }
+        std::vector<std::vector<int> > release_array(number_of_levels);
+        for (int k = 0; k < number_of_levels; ++k) {
+            if (top_parent_array[k] >= 0) {
+                release_array[top_parent_array[k]].push_back(k);
+            }
+        }
+
+        for (int i = number_of_levels - 1; i >= 0; --i) {
+            intx first = level_first_array_[i];
+            intx last = level_first_array_[i + 1];
+            int length = degree_array_[i] + 1;
+            int weight = (i < static_cast<int>(weight_array.size()) ? weight_array[i] : 0);
+            coef_array_[i].resize((last - first) * length);
+
+            for (intx j = first; j < last; ++j) {
+                T* coef = &coef_array_[i][(j - first) * length];
+                int lo_length, hi_length;
+                const T* lo = GetCoef(node_array_[j].first, &lo_length);
+                const T* hi = GetCoef(node_array_[j].second, &hi_length);
+                AddShifted(lo, lo_length, 0, coef);
+                AddShifted(hi, hi_length, weight, coef);
+            }
+            for (uint k = 0; k < release_array[i].size(); ++k) {
+                std::vector<T>().swap(coef_array_[release_array[i][k]]);
+            }
+        }
+
+        int length;
+        const T* root = (node_array_.size() > 2 ? GetCoef(2, &length) : GetCoef(0, &length));
+        result->assign(root, root + length);
+    }
+
+private:
+    const T* GetCoef(intx id, int* length) const
+    {
+        if (id < 2) {
+            *length = 1;
+            return &terminal_array_[id];
+        }
+        int level = level_array_[id];
+        *length = degree_array_[level] + 1;
+        return &coef_array_[level][(id - level_first_array_[level]) * (*length)];
+    }
+
+    // coef[k + shift] += src[k] (0 <= k < length)。単純なループなのでベクトル化される。
+    static void AddShifted(const T* src, int length, int shift, T* coef)
+    {
+        T* dest = coef + shift;
+        for (int k = 0; k < length; ++k) {
+            dest[k] += src[k];
+        }
+    }
+};
+
+//*************************************************************************************************
+// MarginalCalculator<T>: 各変数（辺）について、その変数を含む解の個数を求めるクラス。
+// 下のレベルからの走査で各ノードから 1 終端への経路数を、上のレベルからの走査で
+// 根から各ノードへの経路数を計算すると、変数 i を含む解の個数は
+// レベル i の各ノードについての (根からの経路数) * (hi 子から 1 終端への経路数) の和となる。
+// レベルを飛ばした枝では飛ばされた変数は使われないので、計算はレベル i のノードのみで済む。
+template <typename T>
+class MarginalCalculator {
+private:
+    const std::vector<std::pair<intx, intx> >& node_array_;
+    const std::vector<intx>& level_first_array_;
+    std::vector<T> bottom_array_; // bottom_array_[id]: ノード id から 1 終端への経路数
+    std::vector<T> top_array_; // top_array_[id]: 根からノード id への経路数
+
+public:
+    MarginalCalculator(const std::vector<std::pair<intx, intx> >& node_array,
+                       const std::vector<intx>& level_first_array)
+        : node_array_(node_array), level_first_array_(level_first_array) { }
+
+    // (*result)[i] に変数 i を含む解の個数を格納し、解の総数を返す。
+    T Compute(std::vector<T>* result)
+    {
+        int number_of_levels = static_cast<int>(level_first_array_.size()) - 1;
+        result->assign(number_of_levels, T());
+        if (node_array_.size() <= 2) {
+            return T();
+        }
+
+        bottom_array_.resize(node_array_.size());
+        bottom_array_[0] = 0;
+        bottom_array_[1] = 1;
+        for (intx j = static_cast<intx>(node_array_.size()) - 1; j >= 2; --j) {
+            bottom_array_[j] = bottom_array_[node_array_[j].first];
+            bottom_array_[j] += bottom_array_[node_array_[j].second];
+        }
+
+        top_array_.assign(node_array_.size(), T());
+        top_array_[2] = 1;
+        for (int i = 0; i < number_of_levels; ++i) {
+            for (intx j = level_first_array_[i]; j < level_first_array_[i + 1]; ++j) {
+                top_array_[node_array_[j].first] += top_array_[j];
+                top_array_[node_array_[j].second] += top_array_[j];
+
+                T t = top_array_[j];
+                t *= bottom_array_[node_array_[j].second];
+                (*result)[i] += t;
+            }
+        }
+        return bottom_array_[2];
+    }
+};
+
+//*************************************************************************************************
+// ReliabilityCalculator: 各辺が独立に確率 p で使われるとき、使われる辺の集合が
+// ZDD の表す集合族に属する確率を、複数のシナリオ（確率の組）について同時に計算するクラス。
+// ノードの値はシナリオ方向に連続して並べるので、各ノードの計算はシナリオについての
+// 単純なループとなりベクトル化される。メモリ使用量を抑えるため、シナリオは
+// ブロックに分けて処理する。OpenMP が有効な場合はレベルごとにノードを分割して並列に計算する。
+class ReliabilityCalculator {
+private:
+    enum {MAX_BLOCK_SIZE = 64}; // 1 回の走査で処理するシナリオ数の上限
+    enum {MAX_VALUES = 1 << 25}; // ノードの値を格納する配列の要素数の上限（目安）
+    enum {CHUNK_SIZE = 256}; // 並列計算で 1 度にスレッドに割り当てるノード数
+
+    const std::vector<std::pair<intx, intx> >& node_array_;
+    const std::vector<intx>& level_first_array_;
+    std::vector<int> level_array_; // level_array_[id]: ノード id のレベル
+    int number_of_levels_;
+
+    int block_size_; // 現在のブロックのシナリオ数
+    std::vector<double> value_array_; // value_array_[id * block_size_ + s]
+    // log_rest_array_[i * block_size_ + s]: レベル i より前の、使われない確率が正の辺の
+    // 使われない確率の対数の和。zero_count_array_ は使われない確率が 0 の辺の個数。
+    // レベル a から b の手前までの辺がすべて使われない確率はこれらの差から求める。
+    std::vector<double> log_rest_array_;
+    std::vector<int> zero_count_array_;
+
+public:
+    ReliabilityCalculator(const std::vector<std::pair<intx, intx> >& node_array,
+                          const std::vector<intx>& level_first_array)
+        : node_array_(node_array), level_first_array_(level_first_array)
+    {
+        number_of_levels_ = static_cast<int>(level_first_array_.size()) - 1;
+        MakeNodeLevelArray(node_array_, level_first_array_, &level_array_);
+        level_array_[0] = level_array_[1] = number_of_levels_;
+    }
+
+    // probability_matrix[i][s]: シナリオ s で辺 i が使われる確率。
+    // 行の無いレベル（ノードを持たない末尾のレベル）は変数を持たないものとして扱う。
+    // シナリオ s の確率を (*result)[s] に格納する。
+    void Compute(const std::vector<std::vector<double> >& probability_matrix,
+                 int number_of_scenarios, std::vector<double>* result)
+    {
+        result->assign(number_of_scenarios, 0.0);
+        if (node_array_.size() <= 2) {
+            return;
+        }
+        intx width = MAX_VALUES / static_cast<intx>(node_array_.size());
+        width = std::max<intx>(1, std::min<intx>(MAX_BLOCK_SIZE, width));
+
+        std::vector<double> zero_array(number_of_scenarios, 0.0);
+        std::vector<const double*> prob_array(number_of_levels_);
+        for (int i = 0; i < number_of_levels_; ++i) {
+            prob_array[i] = (i < static_cast<int>(probability_matrix.size())
+                             ? &probability_matrix[i][0] : &zero_array[0]);
+        }
+
+        for (int first = 0; first < number_of_scenarios; first += static_cast<int>(width)) {
+            block_size_ = std::min(static_cast<int>(width), number_of_scenarios - first);
+            ComputeBlock(prob_array, first);
+
+            double gap[MAX_BLOCK_SIZE];
+            GetGap(0, level_array_[2], gap);
+            for (int s = 0; s < block_size_; ++s) {
+                (*result)[first + s] = value_array_[2 * block_size_ + s] * gap[s];
+            }
+        }
+    }
+
+private:
+    // シナリオ offset から block_size_ 個のシナリオについて、全ノードの値を計算する
+    void ComputeBlock(const std::vector<const double*>& prob_array, int offset)
+    {
+        int w = block_size_;
+        log_rest_array_.assign((number_of_levels_ + 1) * w, 0.0);
+        zero_count_array_.assign((number_of_levels_ + 1) * w, 0);
+        for (int i = 0; i < number_of_levels_; ++i) {
+            const double* p = prob_array[i] + offset;
+            for (int s = 0; s < w; ++s) {
+                double q = 1.0 - p[s];
+                log_rest_array_[(i + 1) * w + s] = log_rest_array_[i * w + s]
+                    + (q > 0.0 ? std::log(q) : 0.0);
+                zero_count_array_[(i + 1) * w + s] = zero_count_array_[i * w + s]
+                    + (q > 0.0 ? 0 : 1);
+            }
+        }
+
+        value_array_.resize(node_array_.size() * w);
+        for (int s = 0; s < w; ++s) {
+            value_array_[s] = 0.0;
+            value_array_[w + s] = 1.0;
+        }
+
+        for (int i = number_of_levels_ - 1; i >= 0; --i) {
+            intx first = level_first_array_[i];
+            intx last = level_first_array_[i + 1];
+            const double* p = prob_array[i] + offset;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, CHUNK_SIZE) if (last - first >= 2 * CHUNK_SIZE)
+#endif
+            for (intx j = first; j < last; ++j) {
+                double* value = &value_array_[j * w];
+                const double* lo = &value_array_[node_array_[j].first * w];
+                const double* hi = &value_array_[node_array_[j].second * w];
+                for (int s = 0; s < w; ++s) {
+                    value[s] = (1.0 - p[s]) * lo[s] + p[s] * hi[s];
+                }
+                // 子ノードとの間に飛ばされたレベルがある場合、その辺がすべて使われない確率を掛ける
+                if (IsSkipped(i, node_array_[j].first) || IsSkipped(i, node_array_[j].second)) {
+                    double lo_gap[MAX_BLOCK_SIZE];
+                    double hi_gap[MAX_BLOCK_SIZE];
+                    GetGap(i + 1, level_array_[node_array_[j].first], lo_gap);
+                    GetGap(i + 1, level_array_[node_array_[j].second], hi_gap);
+                    for (int s = 0; s < w; ++s) {
+                        value[s] = (1.0 - p[s]) * lo[s] * lo_gap[s] + p[s] * hi[s] * hi_gap[s];
+                    }
+                }
+            }
+        }
+    }
+
+    bool IsSkipped(int level, intx child) const
+    {
+        return child != 0 && level_array_[child] > level + 1;
+    }
+
+    // レベル a から b の手前までの辺がすべて使われない確率を gap[s] に格納する
+    void GetGap(int a, int b, double* gap) const
+    {
+        int w = block_size_;
+        for (int s = 0; s < w; ++s) {
+            if (zero_count_array_[b * w + s] > zero_count_array_[a * w + s]) {
+                gap[s] = 0.0;
+            } else {
+                gap[s] = std::exp(log_rest_array_[b * w + s] - log_rest_array_[a * w + s]);
+            }
+        }
+    }
+};
+
+//*************************************************************************************************
+// OptimalCalculator: 変数 i（0 から始まるレベル）に重み weight_array[i] を与え、ZDD の解を
+// 重みの和が小さい順（is_max が true なら大きい順）に取り出すクラス。
+// 各ノード v について、v から 1 終端への経路を重みの和の順に並べたリストを必要な分だけ
+// 遅延評価で作る（Jiménez and Marzal の recursive enumeration algorithm）。
+// v のリストの次の要素は、lo 子のリストの次の要素と、hi 子のリストの次の要素に
+// weight_array[v のレベル] を加えたものの小さい方であり、ZDD では子が 2 つなので
+// 候補の優先度付きキューは 2 要素の比較で済む。j 番目の解を初めて求める手間は
+// ZDD の高さに比例する。
 class OptimalCalculator {
+private:
+    struct Entry {
+        intx value; // 経路の重みの和
+        intx child_index; // 子のリストの何番目の経路をたどるか
+        bool is_hi; // hi 子へ進むかどうか
+    };
+
+    const std::vector<std::pair<intx, intx> >& node_array_;
+    std::vector<intx> weight_array_; // is_max の場合は符号を反転して格納する
+    bool is_max_;
+    std::vector<int> level_array_; // level_array_[id]: ノード id のレベル
+    std::vector<std::vector<Entry> > list_array_; // list_array_[id]: ノード id の経路のリスト
+    std::vector<std::pair<intx, intx> > next_array_; // lo 子, hi 子のリストの次に見る位置
+    std::vector<bool> is_complete_array_; // ノード id の経路を全て list_array_[id] に格納済みか
+
 public:
-    static int GetValiableNumber(int node_num,
-                                 const std::vector<intx>& level_first_array) {
+    // weight_array の要素数がレベル数より少ない場合、残りの変数の重みは 0 とする
+    OptimalCalculator(const std::vector<std::pair<intx, intx> >& node_array,
+                      const std::vector<intx>& level_first_array,
+                      const std::vector<intx>& weight_array, bool is_max)
+        : node_array_(node_array), weight_array_(weight_array), is_max_(is_max)
+    {
+        if (weight_array_.size() + 1 < level_first_array.size()) {
+            weight_array_.resize(level_first_array.size() - 1, 0);
+        }
+        if (is_max_) {
+            for (uint i = 0; i < weight_array_.size(); ++i) {
+                weight_array_[i] = -weight_array_[i];
+            }
+        }
+        MakeNodeLevelArray(node_array_, level_first_array, &level_array_);
+        list_array_.resize(node_array_.size());
+        next_array_.resize(node_array_.size(), std::make_pair(0, 0));
+        is_complete_array_.resize(node_array_.size(), false);
+    }
+
+    // rank 番目（0 から始まる）に良い解を求め、その重みの和を (*weight) に、含まれる変数の
+    // 番号（1 から始まる）を (*result) に格納する。解が rank 個以下しかない場合は false を返す。
+    bool GetSolution(intx rank, intx* weight, std::vector<int>* result)
+    {
+        result->clear();
+        if (node_array_.size() <= 2 || !Fill(2, rank)) {
+            return false;
+        }
+        *weight = (is_max_ ? -GetValue(2, rank) : GetValue(2, rank));
+        intx id = 2;
+        intx index = rank;
+        while (id >= 2) {
+            const Entry& entry = list_array_[id][index];
+            index = entry.child_index;
+            if (entry.is_hi) {
+                result->push_back(level_array_[id] + 1);
+                id = node_array_[id].second;
+            } else {
+                id = node_array_[id].first;
+            }
+        }
+        return true;
+    }
 
-        for (uint i = 0; i < level_first_array.size(); ++i) {
-            if (level_first_array[i] <= node_num
-                && node_num < level_first_array[i + 1]) {
-                return i;
+private:
+    // ノード id の経路のリストを index 番目まで作る。経路が index 個以下しかなければ false。
+    bool Fill(intx id, intx index)
+    {
+        if (id <= 1) {
+            return id == 1 && index == 0;
+        }
+        std::vector<Entry>& list = list_array_[id];
+        while (static_cast<intx>(list.size()) <= index) {
+            if (is_complete_array_[id]) {
+                return false;
+            }
+            intx lo = node_array_[id].first;
+            intx hi = node_array_[id].second;
+            std::pair<intx, intx>& next = next_array_[id];
+            bool has_lo = Fill(lo, next.first);
+            bool has_hi = Fill(hi, next.second);
+            if (!has_lo && !has_hi) {
+                is_complete_array_[id] = true;
+                return false;
+            }
+            Entry entry;
+            intx hi_value = (has_hi ? weight_array_[level_array_[id]] + GetValue(hi, next.second)
+                             : 0);
+            if (has_lo && (!has_hi || GetValue(lo, next.first) <= hi_value)) {
+                entry.value = GetValue(lo, next.first);
+                entry.child_index = next.first;
+                entry.is_hi = false;
+                ++next.first;
+            } else {
+                entry.value = hi_value;
+                entry.child_index = next.second;
+                entry.is_hi = true;
+                ++next.second;
             }
+            list.push_back(entry);
         }
-        return -1;
+        return true;
     }
 
-    // This code has not been checked yet!!!
-    static double GetMaximum(const std::vector<std::pair<intx, intx> >& node_array,
-                            const std::vector<intx>& level_first_array,
-                            const Graph& graph,
-                            std::vector<int>* result) {
+    // Fill(id, index) が true を返した後に呼ぶこと
+    intx GetValue(intx id, intx index) const
+    {
+        return (id == 1 ? 0 : list_array_[id][index].value);
+    }
+};
 
-        std::vector<double> value_array;
-        std::vector<int> num_array;
+//*************************************************************************************************
+// ParetoCalculator: 変数 i（0 から始まるレベル）に 2 つの重み (weight1_array[i], weight2_array[i])
+// を与え、重みの和のベクトルが Pareto 最適（両方を最小化）である解を求めるクラス。
+// 各ノードについて、そのノードから 1 終端への経路の重みの和のうち、他に支配されない
+// ものの集合（Pareto フロンティア）をボトムアップに計算する。ノードのフロンティアは、
+// lo 子のフロンティアと、hi 子のフロンティアを変数の重みだけずらしたものとを併合し、
+// 支配される点を取り除いたものである。フロンティアは 1 つ目の重みの昇順（2 つ目の重みの
+// 狭義降順）に保持するので、併合と枝刈りは要素数に比例する時間で済む。
+// 同じ重みの和をもつ解が複数ある場合は、そのうちの 1 つのみを求める。
+class ParetoCalculator {
+private:
+    struct Point {
+        intx value1; // 1 つ目の重みの和
+        intx value2; // 2 つ目の重みの和
+        intx child_index; // 子のフロンティアの何番目の点をたどるか
+        bool is_hi; // hi 子へ進むかどうか
+    };
 
-        value_array.resize(node_array.size());
-        num_array.resize(node_array.size());
+    const std::vector<std::pair<intx, intx> >& node_array_;
+    std::vector<int> level_array_; // level_array_[id]: ノード id のレベル
+    std::vector<std::vector<Point> > frontier_array_; // frontier_array_[id]: ノード id のフロンティア
 
-        value_array[0] = -99999999.9;
-        value_array[1] = 0;
+public:
+    // 重みの配列の要素数がレベル数より少ない場合、残りの変数の重みは 0 とする
+    ParetoCalculator(const std::vector<std::pair<intx, intx> >& node_array,
+                     const std::vector<intx>& level_first_array,
+                     const std::vector<intx>& weight1_array,
+                     const std::vector<intx>& weight2_array)
+        : node_array_(node_array)
+    {
+        MakeNodeLevelArray(node_array_, level_first_array, &level_array_);
 
-        for (intx i = static_cast<intx>(node_array.size()) - 1; i >= 2; --i) {
-            double val = value_array[node_array[i].second] +
-                graph.GetEdge(GetValiableNumber(i, level_first_array)).weight;
+        frontier_array_.resize(node_array_.size());
+        if (node_array_.size() >= 2) {
+            Point point;
+            point.value1 = 0;
+            point.value2 = 0;
+            point.child_index = 0;
+            point.is_hi = false;
+            frontier_array_[1].push_back(point);
+        }
+        for (intx j = static_cast<intx>(node_array_.size()) - 1; j >= 2; --j) {
+            int level = level_array_[j];
+            intx w1 = (level < static_cast<int>(weight1_array.size()) ? weight1_array[level] : 0);
+            intx w2 = (level < static_cast<int>(weight2_array.size()) ? weight2_array[level] : 0);
+            MergeFrontiers(frontier_array_[node_array_[j].first],
+                           frontier_array_[node_array_[j].second], w1, w2,
+                           &frontier_array_[j]);
+        }
+    }
 
-            if (value_array[node_array[i].first] >= val) {
-                value_array[i] = value_array[node_array[i].first];
-                num_array[i] = 0;
+    // Pareto 最適な解の個数（重みの和のベクトルの種類数）
+    intx GetNumberOfSolutions() const
+    {
+        return (node_array_.size() <= 2 ? 0 : static_cast<intx>(frontier_array_[2].size()));
+    }
+
+    // 1 つ目の重みの和が index 番目（0 から始まる）に小さい Pareto 最適な解を求め、
+    // 重みの和を (*value1), (*value2) に、含まれる変数の番号（1 から始まる）を (*result) に
+    // 格納する
+    void GetSolution(intx index, intx* value1, intx* value2, std::vector<int>* result) const
+    {
+        assert(0 <= index && index < GetNumberOfSolutions());
+
+        result->clear();
+        *value1 = frontier_array_[2][index].value1;
+        *value2 = frontier_array_[2][index].value2;
+        intx id = 2;
+        while (id >= 2) {
+            const Point& point = frontier_array_[id][index];
+            index = point.child_index;
+            if (point.is_hi) {
+                result->push_back(level_array_[id] + 1);
+                id = node_array_[id].second;
             } else {
-                value_array[i] = val;
-                num_array[i] = 1;
+                id = node_array_[id].first;
             }
         }
+    }
 
-        intx node = 2;
-        double val2 = 0.0;
-        while (true) {
-            if (num_array[node] == 1) {
-                result->push_back(node);
-                val2 += graph.GetEdge(GetValiableNumber(node, level_first_array)).weight;
-                node = node_array[node].second;
+private:
+    // lo_frontier と、hi_frontier を (w1, w2) だけずらしたものを併合し、支配される点を
+    // 取り除いて (*frontier) に格納する
+    static void MergeFrontiers(const std::vector<Point>& lo_frontier,
+                               const std::vector<Point>& hi_frontier, intx w1, intx w2,
+                               std::vector<Point>* frontier)
+    {
+        uint lo_pos = 0;
+        uint hi_pos = 0;
+        while (lo_pos < lo_frontier.size() || hi_pos < hi_frontier.size()) {
+            Point point;
+            bool is_lo;
+            if (lo_pos >= lo_frontier.size()) {
+                is_lo = false;
+            } else if (hi_pos >= hi_frontier.size()) {
+                is_lo = true;
             } else {
-                node = node_array[node].first;
+                intx hi_value1 = hi_frontier[hi_pos].value1 + w1;
+                intx hi_value2 = hi_frontier[hi_pos].value2 + w2;
+                is_lo = (lo_frontier[lo_pos].value1 < hi_value1
+                         || (lo_frontier[lo_pos].value1 == hi_value1
+                             && lo_frontier[lo_pos].value2 <= hi_value2));
+            }
+            if (is_lo) {
+                point.value1 = lo_frontier[lo_pos].value1;
+                point.value2 = lo_frontier[lo_pos].value2;
+                point.child_index = lo_pos;
+                point.is_hi = false;
+                ++lo_pos;
+            } else {
+                point.value1 = hi_frontier[hi_pos].value1 + w1;
+                point.value2 = hi_frontier[hi_pos].value2 + w2;
+                point.child_index = hi_pos;
+                point.is_hi = true;
+                ++hi_pos;
+            }
+            // 1 つ目の重みの和の昇順に見ているので、2 つ目の重みの和がこれまでの最小値より
+            // 小さい点のみが支配されない
+            if (frontier->empty() || point.value2 < frontier->back().value2) {
+                frontier->push_back(point);
             }
         }
-        return val2;
     }
 };
 
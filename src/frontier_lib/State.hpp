@@ -50,6 +50,7 @@ protected:
     const int number_of_edges_; // # of edges in graph_
     int current_edge_;
     PseudoZDD* subsetting_dd_;
+    std::vector<int> rest_weight_array_; // rest_weight_array_[i]: 辺 i 以降の重みの総和
 
     bool is_print_progress_;
     int print_counter_;
@@ -59,7 +60,14 @@ public:
                           number_of_vertices_((graph != NULL) ? graph->GetNumberOfVertices() : 0),
                           number_of_edges_((graph != NULL) ? graph->GetNumberOfEdges() : 0),
                           current_edge_(-1), subsetting_dd_(subsetting_dd), is_print_progress_(false),
-                          print_counter_(0) { }
+                          print_counter_(0)
+    {
+        rest_weight_array_.resize(number_of_edges_ + 1);
+        rest_weight_array_[number_of_edges_] = 0;
+        for (int i = number_of_edges_ - 1; i >= 0; --i) {
+            rest_weight_array_[i] = rest_weight_array_[i + 1] + graph->GetEdge(i).weight;
+        }
+    }
 
     virtual ~State() { }
 
@@ -88,6 +96,12 @@ public:
         return current_edge_ >= number_of_edges_ - 1;
     }
 
+    // 現在の辺より後の（未処理の）辺の重みの総和
+    int GetRestWeight() const
+    {
+        return rest_weight_array_[current_edge_ + 1];
+    }
+
     virtual void StartNextEdge()
     {
         ++current_edge_;
@@ -154,6 +168,10 @@ public:
 
     int DoSubsetting(int child_num, MateS* mate);
 
+    // 1 終端に遷移するときに返す終端。サブセッティングを行っている場合、
+    // 残りの辺を全て使わない集合がサブセッティングの ZDD に含まれなければ 0 終端を返す。
+    ZDDNode* GetOneTerminal(MateS* mate, PseudoZDD* zdd) const;
+
     virtual ZDDNode* MakeNewNode(ZDDNode* node, Mate* mate,
                                  int child_num, PseudoZDD* zdd) = 0;
     virtual Mate* Initialize(ZDDNode* root_node) = 0;
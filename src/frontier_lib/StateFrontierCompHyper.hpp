@@ -70,7 +70,7 @@ public:
         if (c == 0) { // 0終端に行くとき
             return zdd->ZeroTerminal; // 0終端を返す
         } else if (c == 1) { // 1終端に行くとき
-            return zdd->OneTerminal; // 1終端を返す
+            return State::GetOneTerminal(m, zdd); // 1終端を返す
         }
 
         this->UpdateMate(m, child_num); // mate を更新する
@@ -79,7 +79,7 @@ public:
         if (c == 0) { // 0終端に行くとき
             return zdd->ZeroTerminal; // 0終端を返す
         } else if (c == 1) { // 1終端に行くとき
-            return zdd->OneTerminal; // 1終端を返す
+            return State::GetOneTerminal(m, zdd); // 1終端を返す
         } else {
             RenameComp(m);
 
@@ -61,6 +61,14 @@ inline int State::DoSubsetting(int child_num, MateS* mate)
     return 1;
 }
 
+inline ZDDNode* State::GetOneTerminal(MateS* mate, PseudoZDD* zdd) const
+{
+    if (mate->IsUseSubsetting() && !subsetting_dd_->ContainsEmptySet(mate->sdd)) {
+        return zdd->ZeroTerminal;
+    }
+    return zdd->OneTerminal;
+}
+
 
 } // the end of the namespace
 
@@ -0,0 +1,329 @@
+//
+// ZDDApply.hpp
+//
+// Copyright (c) 2012 -- 2016 Jun Kawahara
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use, copy, modify, merge, publish,
+// distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or
+// substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#ifndef ZDDAPPLY_HPP
+#define ZDDAPPLY_HPP
+
+#include <vector>
+#include <climits>
+#include <algorithm>
+
+#include "Global.hpp"
+#include "PseudoZDD.hpp"
+
+namespace frontier_lib {
+
+//*************************************************************************************************
+// ZDDApply: 構築済みの ZDD どうしの集合演算を行うクラス。
+// 変数の順序（レベル i が辺 i）が共通の ZDD を Import で取り込み、和集合、共通部分、差、
+// 結合積 {A ∪ B}、直積 {A ∪ B | A ∩ B = ∅} を計算して Export で PseudoZDD に戻す。
+// ノードは一意表で共有するので、ZDD は常に既約である。演算結果は演算表（キャッシュ）に
+// 記録し、同じ引数の演算を繰り返さない。演算表は衝突したら上書きする。
+class ZDDApply {
+public:
+    enum { // operation
+        UNION,
+        INTERSECTION,
+        DIFFERENCE,
+        JOIN,
+        DISJOINT_PRODUCT
+    };
+
+private:
+    enum {TERMINAL_LEVEL = INT_MAX}; // 終端のレベル
+    enum {INITIAL_CACHE_SIZE = 1 << 16};
+
+    struct Node {
+        int level;
+        intx lo;
+        intx hi;
+    };
+
+    struct CacheEntry {
+        int op;
+        intx f;
+        intx g;
+        intx result;
+    };
+
+    std::vector<Node> node_array_; // 0, 1 番は終端
+    std::vector<intx> unique_table_; // node_array_ の番号を格納するハッシュ表。空きは -1
+    std::vector<CacheEntry> cache_;
+    int number_of_levels_;
+
+public:
+    ZDDApply() : number_of_levels_(0)
+    {
+        Node terminal = {TERMINAL_LEVEL, -1, -1};
+        node_array_.push_back(terminal); // 0-terminal
+        node_array_.push_back(terminal); // 1-terminal
+        unique_table_.assign(INITIAL_CACHE_SIZE, -1);
+        ClearCache(INITIAL_CACHE_SIZE);
+    }
+
+    // zdd を取り込み、その根の番号を返す
+    intx Import(const PseudoZDD& zdd)
+    {
+        const std::vector<std::pair<intx, intx> >& node_array = zdd.GetNodeArray();
+        const std::vector<intx>& level_first_array = zdd.GetLevelFirstArray();
+        int number_of_levels = static_cast<int>(level_first_array.size()) - 1;
+        number_of_levels_ = std::max(number_of_levels_, number_of_levels);
+        if (node_array.size() <= 2) {
+            return 0;
+        }
+
+        std::vector<intx> id_array(node_array.size()); // 元のノード番号から取り込んだ番号へ
+        id_array[0] = 0;
+        id_array[1] = 1;
+        for (int i = number_of_levels - 1; i >= 0; --i) {
+            for (intx j = level_first_array[i]; j < level_first_array[i + 1]; ++j) {
+                id_array[j] = GetNode(i, id_array[node_array[j].first],
+                                      id_array[node_array[j].second]);
+            }
+        }
+        return id_array[2];
+    }
+
+    // f から到達できるノードからなる PseudoZDD を作って返す。
+    // f が終端の場合、根は f を lo 子に持つノードとする。
+    PseudoZDD* Export(intx f) const
+    {
+        std::vector<std::pair<intx, intx> > new_node_array(2, std::make_pair(-1, -1));
+        std::vector<intx> level_first_array(number_of_levels_ + 1);
+
+        if (f < 2) {
+            new_node_array.push_back(std::make_pair(f, 0));
+            level_first_array[0] = 2;
+            for (int i = 1; i <= number_of_levels_; ++i) {
+                level_first_array[i] = 3;
+            }
+        } else {
+            // 到達できるノードをレベルごとに集め、レベル順に番号を付け直す
+            std::vector<std::vector<intx> > level_node_array(number_of_levels_);
+            std::vector<intx> id_array(node_array_.size(), -1);
+            std::vector<intx> stack;
+            stack.push_back(f);
+            id_array[f] = 0;
+            while (!stack.empty()) {
+                intx x = stack.back();
+                stack.pop_back();
+                level_node_array[node_array_[x].level].push_back(x);
+                intx child[2] = {node_array_[x].lo, node_array_[x].hi};
+                for (int c = 0; c < 2; ++c) {
+                    if (child[c] >= 2 && id_array[child[c]] < 0) {
+                        id_array[child[c]] = 0;
+                        stack.push_back(child[c]);
+                    }
+                }
+            }
+            id_array[0] = 0;
+            id_array[1] = 1;
+            intx count = 2;
+            for (int i = 0; i < number_of_levels_; ++i) {
+                level_first_array[i] = count;
+                for (uint k = 0; k < level_node_array[i].size(); ++k) {
+                    id_array[level_node_array[i][k]] = count;
+                    ++count;
+                }
+            }
+            level_first_array[number_of_levels_] = count;
+            for (int i = 0; i < number_of_levels_; ++i) {
+                for (uint k = 0; k < level_node_array[i].size(); ++k) {
+                    const Node& node = node_array_[level_node_array[i][k]];
+                    new_node_array.push_back(std::make_pair(id_array[node.lo], id_array[node.hi]));
+                }
+            }
+        }
+
+        PseudoZDD* zdd = new PseudoZDD;
+        zdd->SetNodeArray(new_node_array, level_first_array);
+        return zdd;
+    }
+
+    intx Union(intx f, intx g)
+    {
+        return Apply(UNION, f, g);
+    }
+
+    intx Intersection(intx f, intx g)
+    {
+        return Apply(INTERSECTION, f, g);
+    }
+
+    intx Difference(intx f, intx g)
+    {
+        return Apply(DIFFERENCE, f, g);
+    }
+
+    intx Join(intx f, intx g)
+    {
+        return Apply(JOIN, f, g);
+    }
+
+    intx DisjointProduct(intx f, intx g)
+    {
+        return Apply(DISJOINT_PRODUCT, f, g);
+    }
+
+    intx Apply(int op, intx f, intx g)
+    {
+        switch (op) { // 終端の場合
+        case UNION:
+            if (f == 0 || f == g) {
+                return g;
+            } else if (g == 0) {
+                return f;
+            }
+            break;
+        case INTERSECTION:
+            if (f == 0 || g == 0) {
+                return 0;
+            } else if (f == g) {
+                return f;
+            }
+            break;
+        case DIFFERENCE:
+            if (f == 0 || f == g) {
+                return 0;
+            } else if (g == 0) {
+                return f;
+            }
+            break;
+        case JOIN:
+        case DISJOINT_PRODUCT:
+            if (f == 0 || g == 0) {
+                return 0;
+            } else if (f == 1) {
+                return g;
+            } else if (g == 1) {
+                return f;
+            }
+            break;
+        }
+        if (op != DIFFERENCE && f > g) { // 可換な演算は引数の順序を揃えて演算表に記録する
+            std::swap(f, g);
+        }
+
+        CacheEntry& entry = cache_[GetHashValue(op, f, g) & (cache_.size() - 1)];
+        if (entry.op == op && entry.f == f && entry.g == g) {
+            return entry.result;
+        }
+
+        // 上のレベルの変数で分解する。変数を持たない側は hi 子が 0-終端であるとみなす。
+        int level = std::min(node_array_[f].level, node_array_[g].level);
+        intx f0 = (node_array_[f].level == level ? node_array_[f].lo : f);
+        intx f1 = (node_array_[f].level == level ? node_array_[f].hi : 0);
+        intx g0 = (node_array_[g].level == level ? node_array_[g].lo : g);
+        intx g1 = (node_array_[g].level == level ? node_array_[g].hi : 0);
+
+        intx lo, hi;
+        switch (op) {
+        case JOIN:
+            lo = Apply(JOIN, f0, g0);
+            hi = Apply(UNION, Apply(UNION, Apply(JOIN, f1, g1), Apply(JOIN, f1, g0)),
+                       Apply(JOIN, f0, g1));
+            break;
+        case DISJOINT_PRODUCT:
+            lo = Apply(DISJOINT_PRODUCT, f0, g0);
+            hi = Apply(UNION, Apply(DISJOINT_PRODUCT, f1, g0), Apply(DISJOINT_PRODUCT, f0, g1));
+            break;
+        default:
+            lo = Apply(op, f0, g0);
+            hi = Apply(op, f1, g1);
+            break;
+        }
+        intx result = GetNode(level, lo, hi);
+
+        // 再帰呼び出しの間に演算表が作り直されている場合があるので、改めて場所を求める
+        CacheEntry& new_entry = cache_[GetHashValue(op, f, g) & (cache_.size() - 1)];
+        new_entry.op = op;
+        new_entry.f = f;
+        new_entry.g = g;
+        new_entry.result = result;
+        return result;
+    }
+
+    intx GetNumberOfNodes() const
+    {
+        return static_cast<intx>(node_array_.size());
+    }
+
+private:
+    // レベル level で子が lo, hi のノードを一意表から探し、無ければ作る
+    intx GetNode(int level, intx lo, intx hi)
+    {
+        if (hi == 0) { // zero-suppressed rule
+            return lo;
+        }
+        uintx mask = unique_table_.size() - 1;
+        uintx k = GetHashValue(level, lo, hi) & mask;
+        while (unique_table_[k] >= 0) {
+            const Node& node = node_array_[unique_table_[k]];
+            if (node.level == level && node.lo == lo && node.hi == hi) {
+                return unique_table_[k];
+            }
+            k = (k + 1) & mask;
+        }
+
+        Node node = {level, lo, hi};
+        intx id = static_cast<intx>(node_array_.size());
+        node_array_.push_back(node);
+        unique_table_[k] = id;
+
+        if (static_cast<uintx>(node_array_.size()) * 2 > unique_table_.size()) {
+            Rehash();
+        }
+        if (node_array_.size() > cache_.size()) {
+            ClearCache(cache_.size() * 2);
+        }
+        return id;
+    }
+
+    void Rehash()
+    {
+        unique_table_.assign(unique_table_.size() * 2, -1);
+        uintx mask = unique_table_.size() - 1;
+        for (intx id = 2; id < static_cast<intx>(node_array_.size()); ++id) {
+            const Node& node = node_array_[id];
+            uintx k = GetHashValue(node.level, node.lo, node.hi) & mask;
+            while (unique_table_[k] >= 0) {
+                k = (k + 1) & mask;
+            }
+            unique_table_[k] = id;
+        }
+    }
+
+    void ClearCache(uintx size)
+    {
+        CacheEntry entry = {-1, -1, -1, -1};
+        cache_.assign(size, entry);
+    }
+
+    static uintx GetHashValue(int a, intx b, intx c)
+    {
+        uintx hash_value = (static_cast<uintx>(a) * 15284356289ll + static_cast<uintx>(b))
+            * 15284356289ll + static_cast<uintx>(c);
+        return hash_value ^ (hash_value >> 31);
+    }
+};
+
+} // the end of the namespace
+
+#endif // ZDDAPPLY_HPP
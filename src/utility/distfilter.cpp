@@ -20,7 +20,7 @@
 
 #include <iostream>
 #include <cstdlib>
-#include <algorithm>
+#include <vector>
 
 #include "../frontier_lib/Graph.hpp"
 
@@ -40,12 +40,15 @@ int main(int argc, char** argv)
 
     Graph graph;
     graph.LoadEdgeList(cin);
-    graph.FloydWarshall();
 
-    const vector<vector<int> >& dist_matrix = graph.GetDistMatrix();
+    // s と t からの単一始点最短距離だけを求める
+    vector<int> start_dist_array;
+    vector<int> end_dist_array;
+    graph.ComputeShortestDistance(start, &start_dist_array);
+    graph.ComputeShortestDistance(end, &end_dist_array);
 
     cerr << "start: " << start << ", end:" << end << endl;
-    cerr << "min dist: " << dist_matrix[start][end] << endl;
+    cerr << "min dist: " << start_dist_array[end] << endl;
 
     if (max_distance > 0) {
         std::vector<int> new_var_array;
@@ -54,8 +57,9 @@ int main(int argc, char** argv)
         int new_vertex_num = 1;
 
         for (int i = 1; i <= graph.GetNumberOfVertices(); ++i) {
-            if (dist_matrix[start][i] + dist_matrix[i][end] > max_distance) {
+            if (start_dist_array[i] + end_dist_array[i] > max_distance) {
                 remove_array.push_back(i);
+                new_var_array[i] = 0; // removed
             } else {
                 new_var_array[i] = new_vertex_num;
                 ++new_vertex_num;
@@ -67,7 +71,7 @@ int main(int argc, char** argv)
         //}
         cerr << "rename vertices:" << endl;
         for (int i = 1; i <= graph.GetNumberOfVertices(); ++i) {
-            if (std::find(remove_array.begin(), remove_array.end(), i) == remove_array.end()) {
+            if (new_var_array[i] > 0) {
                 cerr << i << " -> " << new_var_array[i] << endl;
             }
         }